@@ -0,0 +1,139 @@
+#ifndef BLOCK_TYPES_HPP
+#define BLOCK_TYPES_HPP
+
+#include "raylib.h"
+#include <array>
+#include <cstdint>
+
+// Optimized block types with integer IDs
+enum BlockType : unsigned char {
+    BLOCK_AIR = 0,
+    BLOCK_GRASS,
+    BLOCK_DIRT,
+    BLOCK_STONE,
+    BLOCK_WOOD,
+    BLOCK_LEAVES,
+    BLOCK_WATER,
+    BLOCK_SAND,
+    BLOCK_SLAB,
+    BLOCK_COUNT
+};
+
+// Which mesh a block's faces go into
+enum RenderLayer : unsigned char {
+    RENDER_LAYER_NONE = 0,
+    RENDER_LAYER_OPAQUE,
+    RENDER_LAYER_TRANSLUCENT
+};
+
+// Everything the engine knows about a block type. Adding a block is one enum value
+// and one row in BLOCK_DEFINITIONS.
+struct BlockDefinition {
+    BlockType type;
+    Color color;
+    bool solid;        // Blocks movement and counts for occupancy
+    bool opaque;       // Hides the faces of neighbouring blocks
+    bool stateful;     // Reads the per-block state nibble when meshed or collided with
+    unsigned char lightEmission;
+    float hardness;
+    RenderLayer layer;
+};
+
+inline constexpr BlockDefinition BLOCK_DEFINITIONS[] = {
+    // type          color                       solid  opaque state  light hardness layer
+    { BLOCK_AIR,    BLANK,                       false, false, false, 0,   0.0f, RENDER_LAYER_NONE },
+    { BLOCK_GRASS,  GREEN,                       true,  true,  false, 0,   0.6f, RENDER_LAYER_OPAQUE },
+    { BLOCK_DIRT,   BROWN,                       true,  true,  false, 0,   0.5f, RENDER_LAYER_OPAQUE },
+    { BLOCK_STONE,  GRAY,                        true,  true,  false, 0,   1.5f, RENDER_LAYER_OPAQUE },
+    { BLOCK_WOOD,   Color{ 139, 69, 19, 255 },   true,  true,  true,  0,   2.0f, RENDER_LAYER_OPAQUE },
+    { BLOCK_LEAVES, Color{ 34, 139, 34, 200 },   true,  false, false, 0,   0.2f, RENDER_LAYER_TRANSLUCENT },
+    { BLOCK_WATER,  Color{ 0, 105, 148, 150 },   false, false, true,  0, 100.0f, RENDER_LAYER_TRANSLUCENT },
+    { BLOCK_SAND,   Color{ 194, 178, 128, 255 }, true,  true,  false, 0,   0.5f, RENDER_LAYER_OPAQUE },
+    { BLOCK_SLAB,   Color{ 150, 150, 150, 255 }, true,  false, true,  0,   1.5f, RENDER_LAYER_OPAQUE },
+};
+
+static_assert(std::size(BLOCK_DEFINITIONS) == BLOCK_COUNT, "Every block type needs a definition row");
+
+// Packed per-type flags. The tables cover every byte value, so lookups never need a
+// range check; unknown types behave like air.
+enum BlockFlag : unsigned char {
+    BLOCK_FLAG_SOLID = 1 << 0,
+    BLOCK_FLAG_OPAQUE = 1 << 1,
+    BLOCK_FLAG_TRANSLUCENT = 1 << 2,
+    BLOCK_FLAG_VISIBLE = 1 << 3,
+    BLOCK_FLAG_EMISSIVE = 1 << 4,
+    BLOCK_FLAG_STATEFUL = 1 << 5
+};
+
+// Per-block state is a 4-bit value whose meaning depends on the type; 0 is the default
+// every generated block has, so only edited blocks ever store anything.
+// Water: how far the level has dropped below a full source block.
+// Wood: the axis the log runs along. Slab: which half of the cell it fills.
+const int BLOCK_STATE_BITS = 4;
+const unsigned char BLOCK_STATE_MASK = (1 << BLOCK_STATE_BITS) - 1;
+const int WATER_LEVELS = 8;
+
+enum BlockAxis : unsigned char {
+    BLOCK_AXIS_Y = 0,
+    BLOCK_AXIS_X,
+    BLOCK_AXIS_Z
+};
+
+enum SlabHalf : unsigned char {
+    SLAB_BOTTOM = 0,
+    SLAB_TOP
+};
+
+// Vertical span of a block's shape inside its cell
+struct BlockExtent {
+    float bottom;
+    float top;
+};
+
+constexpr BlockExtent GetBlockExtent(unsigned char type, unsigned char state) {
+    if (type == BLOCK_SLAB) {
+        return state == SLAB_TOP ? BlockExtent{ 0.5f, 1.0f } : BlockExtent{ 0.0f, 0.5f };
+    }
+    return BlockExtent{ 0.0f, 1.0f };
+}
+
+namespace BlockTables {
+    constexpr std::array<unsigned char, 256> BuildFlags() {
+        std::array<unsigned char, 256> flags{};
+        for (const BlockDefinition& definition : BLOCK_DEFINITIONS) {
+            unsigned char& entry = flags[definition.type];
+            if (definition.solid) entry |= BLOCK_FLAG_SOLID;
+            if (definition.opaque) entry |= BLOCK_FLAG_OPAQUE;
+            if (definition.layer == RENDER_LAYER_TRANSLUCENT) entry |= BLOCK_FLAG_TRANSLUCENT;
+            if (definition.layer != RENDER_LAYER_NONE) entry |= BLOCK_FLAG_VISIBLE;
+            if (definition.lightEmission > 0) entry |= BLOCK_FLAG_EMISSIVE;
+            if (definition.stateful) entry |= BLOCK_FLAG_STATEFUL;
+        }
+        return flags;
+    }
+
+    constexpr std::array<Color, 256> BuildColors() {
+        std::array<Color, 256> colors{};
+        for (const BlockDefinition& definition : BLOCK_DEFINITIONS) {
+            colors[definition.type] = definition.color;
+        }
+        return colors;
+    }
+
+    constexpr std::array<BlockDefinition, 256> BuildDefinitions() {
+        std::array<BlockDefinition, 256> definitions{};
+        for (BlockDefinition& definition : definitions) {
+            definition = BLOCK_DEFINITIONS[BLOCK_AIR];
+        }
+        for (const BlockDefinition& definition : BLOCK_DEFINITIONS) {
+            definitions[definition.type] = definition;
+        }
+        return definitions;
+    }
+
+    inline constexpr std::array<unsigned char, 256> FLAGS = BuildFlags();
+    inline constexpr std::array<Color, 256> COLORS = BuildColors();
+    inline constexpr std::array<BlockDefinition, 256> DEFINITIONS = BuildDefinitions();
+}
+
+#endif
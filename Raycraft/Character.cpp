@@ -4,8 +4,18 @@
 #include <iostream>
 #include <algorithm>
 
+namespace {
+    // Touching faces are not overlaps; keeps resting contacts stable
+    const float COLLISION_EPSILON = 0.001f;
+
+    float& Axis(Vector3& v, int axis) {
+        return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+    }
+}
+
 Character::Character(OptimizedWorld* worldRef, Vector3 startPos)
     : position(startPos),
+    previousPosition(startPos),
     velocity({ 0, 0, 0 }),
     size({ 0.6f, 1.8f, 0.6f }),
     speed(4.0f),
@@ -16,6 +26,9 @@ Character::Character(OptimizedWorld* worldRef, Vector3 startPos)
     cameraPitch(0.0f),
     cameraYaw(-90.0f),
     mouseSensitivity(0.1f),
+    input{},
+    lookPitch(0.0f),
+    lookYaw(-90.0f),
     isWalking(false),
     isRunning(false),
     isJumping(false),
@@ -27,6 +40,10 @@ Character::Character(OptimizedWorld* worldRef, Vector3 startPos)
     isBreaking(false),
     world(worldRef) {
 
+    input.yaw = cameraYaw;
+    input.pitch = cameraPitch;
+    input.selectedBlock = selectedBlockType;
+
     // Initialize camera
     camera.position = position;
     camera.position.y += 1.6f; // Eye height
@@ -40,27 +57,67 @@ Character::Character(OptimizedWorld* worldRef, Vector3 startPos)
     HideCursor();
 }
 
-void Character::Update() {
-    HandleInput();
-    UpdateCamera();
-    UpdatePhysics();
-    UpdateCameraBobbing();
+void Character::PollInput() {
+    // Mouse look is applied every frame so the view stays responsive between ticks
+    Vector2 mouseDelta = Vector2Subtract(GetMousePosition(), lastMousePosition);
+    lastMousePosition = GetMousePosition();
 
-    // Update camera position (account for bobbing)
-    Vector3 cameraPos = position;
-    cameraPos.y += 1.6f;
+    cameraYaw += mouseDelta.x * mouseSensitivity;
+    cameraPitch -= mouseDelta.y * mouseSensitivity;
 
-    // Add bobbing effect when walking
-    if (isWalking && isGrounded && !isFlying) {
-        cameraPos.y += sinf(bobTimer * 10.0f) * 0.05f;
-    }
+    // Clamp pitch to prevent flipping
+    if (cameraPitch > 89.0f) cameraPitch = 89.0f;
+    if (cameraPitch < -89.0f) cameraPitch = -89.0f;
+    if (cameraYaw > 360.0f) cameraYaw -= 360.0f;
+    if (cameraYaw < -360.0f) cameraYaw += 360.0f;
 
-    camera.position = cameraPos;
-    camera.target = Vector3Add(camera.position, GetForwardVector());
+    input.yaw = cameraYaw;
+    input.pitch = cameraPitch;
+
+    // Held state is simply the latest sample
+    input.forward = IsKeyDown(KEY_W);
+    input.back = IsKeyDown(KEY_S);
+    input.left = IsKeyDown(KEY_A);
+    input.right = IsKeyDown(KEY_D);
+    input.up = IsKeyDown(KEY_SPACE);
+    input.down = IsKeyDown(KEY_LEFT_CONTROL);
+    input.sprint = IsKeyDown(KEY_LEFT_SHIFT);
+    input.breakHeld = IsMouseButtonDown(MOUSE_LEFT_BUTTON);
+
+    // Presses stick until a tick sees them, even if several frames pass without one
+    input.jump = input.jump || IsKeyPressed(KEY_SPACE);
+    input.toggleFly = input.toggleFly || IsKeyPressed(KEY_F);
+    input.breakReleased = input.breakReleased || IsMouseButtonReleased(MOUSE_LEFT_BUTTON);
+    input.place = input.place || IsMouseButtonPressed(MOUSE_RIGHT_BUTTON);
+
+    // Block selection
+    if (IsKeyPressed(KEY_ONE)) input.selectedBlock = 1;
+    if (IsKeyPressed(KEY_TWO)) input.selectedBlock = 2;
+    if (IsKeyPressed(KEY_THREE)) input.selectedBlock = 3;
+    if (IsKeyPressed(KEY_FOUR)) input.selectedBlock = 4;
+    if (IsKeyPressed(KEY_FIVE)) input.selectedBlock = 5;
+    if (IsKeyPressed(KEY_SIX)) input.selectedBlock = BLOCK_SLAB;
+}
+
+void Character::Tick(float dt) {
+    Simulate(input, dt);
+
+    input.jump = false;
+    input.toggleFly = false;
+    input.breakReleased = false;
+    input.place = false;
+}
+
+void Character::Simulate(const PlayerInput& tickInput, float dt) {
+    previousPosition = position;
+
+    HandleInput(tickInput);
+    UpdatePhysics(dt);
+    UpdateCameraBobbing(dt);
 
     // Update breaking progress
     if (isBreaking) {
-        breakTimer += GetFrameTime();
+        breakTimer += dt;
         breakProgress = breakTimer / 1.0f; // 1 second to break a block
 
         if (breakTimer >= 1.0f) {
@@ -72,57 +129,63 @@ void Character::Update() {
     }
 }
 
-void Character::HandleInput() {
-    // Mouse input
-    Vector2 mouseDelta = Vector2Subtract(GetMousePosition(), lastMousePosition);
-    lastMousePosition = GetMousePosition();
+void Character::UpdateCamera(float alpha) {
+    // Render between the last two ticks so motion is smooth at any frame rate
+    Vector3 cameraPos = Vector3Lerp(previousPosition, position, alpha);
+    cameraPos.y += 1.6f;
 
-    cameraYaw += mouseDelta.x * mouseSensitivity;
-    cameraPitch -= mouseDelta.y * mouseSensitivity;
+    // Add bobbing effect when walking
+    if (isWalking && isGrounded && !isFlying) {
+        cameraPos.y += sinf(bobTimer * 10.0f) * 0.05f;
+    }
 
-    // Clamp pitch to prevent flipping
-    if (cameraPitch > 89.0f) cameraPitch = 89.0f;
-    if (cameraPitch < -89.0f) cameraPitch = -89.0f;
+    camera.position = cameraPos;
+    camera.target = Vector3Add(camera.position, GetForwardVector());
+}
+
+void Character::HandleInput(const PlayerInput& tickInput) {
+    lookYaw = tickInput.yaw;
+    lookPitch = tickInput.pitch;
 
     // Movement
     Vector3 moveDirection = { 0, 0, 0 };
     isWalking = false;
 
-    Vector3 forward = GetForwardVector();
+    Vector3 forward = GetLookVector();
     forward.y = 0;
     Vector3 forwardNormalized = Vector3Normalize(forward);
 
     Vector3 right = Vector3CrossProduct(forwardNormalized, Vector3{ 0.0f, 1.0f, 0.0f });
     right = Vector3Normalize(right);
 
-    if (IsKeyDown(KEY_W)) {
+    if (tickInput.forward) {
         moveDirection = Vector3Add(moveDirection, forwardNormalized);
         isWalking = true;
     }
-    if (IsKeyDown(KEY_S)) {
+    if (tickInput.back) {
         moveDirection = Vector3Subtract(moveDirection, forwardNormalized);
         isWalking = true;
     }
-    if (IsKeyDown(KEY_A)) {
+    if (tickInput.left) {
         moveDirection = Vector3Subtract(moveDirection, right);
         isWalking = true;
     }
-    if (IsKeyDown(KEY_D)) {
+    if (tickInput.right) {
         moveDirection = Vector3Add(moveDirection, right);
         isWalking = true;
     }
 
     // Sprint
-    isRunning = IsKeyDown(KEY_LEFT_SHIFT);
+    isRunning = tickInput.sprint;
     float currentSpeed = isRunning ? speed * 1.8f : speed;
 
     // Flying movement (up/down)
     if (isFlying) {
-        if (IsKeyDown(KEY_SPACE)) {
+        if (tickInput.up) {
             moveDirection.y += 1.0f;
             isWalking = true;
         }
-        if (IsKeyDown(KEY_LEFT_CONTROL)) {
+        if (tickInput.down) {
             moveDirection.y -= 1.0f;
             isWalking = true;
         }
@@ -143,13 +206,13 @@ void Character::HandleInput() {
     }
 
     // Jump (only if not flying)
-    if (!isFlying && IsKeyPressed(KEY_SPACE) && isGrounded) {
+    if (!isFlying && tickInput.jump && isGrounded) {
         velocity.y = jumpForce;
         isJumping = true;
     }
 
     // Toggle flying mode
-    if (IsKeyPressed(KEY_F)) {
+    if (tickInput.toggleFly) {
         ToggleFlying();
         if (isFlying) {
             velocity.y = 0;
@@ -157,14 +220,10 @@ void Character::HandleInput() {
     }
 
     // Block selection
-    if (IsKeyPressed(KEY_ONE)) selectedBlockType = 1;
-    if (IsKeyPressed(KEY_TWO)) selectedBlockType = 2;
-    if (IsKeyPressed(KEY_THREE)) selectedBlockType = 3;
-    if (IsKeyPressed(KEY_FOUR)) selectedBlockType = 4;
-    if (IsKeyPressed(KEY_FIVE)) selectedBlockType = 5;
+    selectedBlockType = tickInput.selectedBlock;
 
     // Block interaction
-    if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
+    if (tickInput.breakHeld) {
         Vector3 hitPos, normal, blockPos;
         if (RaycastBlock(hitPos, normal, blockPos, reachDistance)) {
             if (!isBreaking || !Vector3Equals(breakingBlock, blockPos)) {
@@ -178,7 +237,7 @@ void Character::HandleInput() {
             breakProgress = 0.0f;
         }
     }
-    else if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
+    else if (tickInput.breakReleased) {
         if (isBreaking && breakProgress >= 1.0f) {
             world->BreakBlock(breakingBlock);
         }
@@ -187,7 +246,7 @@ void Character::HandleInput() {
         breakTimer = 0.0f;
     }
 
-    if (IsMouseButtonPressed(MOUSE_RIGHT_BUTTON)) {
+    if (tickInput.place) {
         Vector3 hitPos, normal, blockPos;
         if (RaycastBlock(hitPos, normal, blockPos, reachDistance)) {
             // Calculate placement position (adjacent to hit face)
@@ -201,48 +260,27 @@ void Character::HandleInput() {
             Vector3 playerPos = GetPosition();
             float distance = Vector3Distance(placePos, playerPos);
             if (distance > 1.5f) {
-                world->PlaceBlock(placePos, selectedBlockType);
+                world->PlaceBlock(placePos, selectedBlockType, normal, hitPos);
             }
         }
     }
 }
 
-void Character::UpdateCamera() {
-    if (cameraYaw > 360.0f) cameraYaw -= 360.0f;
-    if (cameraYaw < -360.0f) cameraYaw += 360.0f;
-}
-
-void Character::UpdatePhysics() {
+void Character::UpdatePhysics(float dt) {
     if (!isFlying) {
-        velocity.y -= gravity * GetFrameTime();
+        velocity.y -= gravity * dt;
     }
 
-    Vector3 newPos = position;
-    newPos.x += velocity.x * GetFrameTime();
-    newPos.z += velocity.z * GetFrameTime();
-    newPos.y += velocity.y * GetFrameTime();
+    CollisionResult result = MoveAndCollide(position, Vector3Scale(velocity, dt));
+    position = result.position;
 
-    if (CheckCollision(newPos)) {
-        Vector3 resolvedPos = ResolveCollision(newPos);
-        position = resolvedPos;
+    if (result.normal.x != 0.0f) velocity.x = 0;
+    if (result.normal.z != 0.0f) velocity.z = 0;
+    if (result.normal.y != 0.0f) velocity.y = 0;
 
-        Vector3 belowPos = position;
-        belowPos.y -= 0.1f;
-        if (CheckCollision(belowPos)) {
-            isGrounded = true;
-            velocity.y = 0;
-            isJumping = false;
-        }
-        else {
-            isGrounded = false;
-        }
-
-        if (fabs(resolvedPos.x - newPos.x) > 0.01f) velocity.x = 0;
-        if (fabs(resolvedPos.z - newPos.z) > 0.01f) velocity.z = 0;
-    }
-    else {
-        position = newPos;
-        isGrounded = false;
+    isGrounded = result.normal.y > 0.0f;
+    if (isGrounded) {
+        isJumping = false;
     }
 
     if (isGrounded && !isFlying) {
@@ -252,13 +290,14 @@ void Character::UpdatePhysics() {
 
     if (position.y < -10.0f) {
         position.y = 20.0f;
+        previousPosition = position;
         velocity = Vector3{ 0, 0, 0 };
     }
 }
 
-void Character::UpdateCameraBobbing() {
+void Character::UpdateCameraBobbing(float dt) {
     if (isWalking && (isGrounded || isFlying)) {
-        bobTimer += GetFrameTime() * (isRunning ? 1.5f : 1.0f);
+        bobTimer += dt * (isRunning ? 1.5f : 1.0f);
         if (bobTimer > 2 * PI) {
             bobTimer -= 2 * PI;
         }
@@ -280,67 +319,39 @@ Vector3 Character::GetForwardVector() {
     return Vector3Normalize(direction);
 }
 
+Vector3 Character::GetLookVector() const {
+    // Same as GetForwardVector but from the simulated look angles
+    Vector3 direction;
+    float yawRad = lookYaw * DEG2RAD;
+    float pitchRad = lookPitch * DEG2RAD;
+
+    direction.x = cosf(yawRad) * cosf(pitchRad);
+    direction.y = sinf(pitchRad);
+    direction.z = sinf(yawRad) * cosf(pitchRad);
+
+    return Vector3Normalize(direction);
+}
+
+Vector3 Character::GetEyePosition() const {
+    return { position.x, position.y + 1.6f, position.z };
+}
+
 Vector3 Character::GetTargetPosition(float distance) {
     Vector3 forward = GetForwardVector();
     return Vector3Add(camera.position, Vector3Scale(forward, distance));
 }
 
 bool Character::RaycastBlock(Vector3& hitPos, Vector3& normal, Vector3& blockPos, float maxDistance) {
-    Vector3 rayStart = camera.position;
-    Vector3 rayDir = GetForwardVector();
-    Vector3 rayEnd = Vector3Add(rayStart, Vector3Scale(rayDir, maxDistance));
-
-    // Use raylib's built-in raycast for better performance
-    Ray ray = { rayStart, rayDir };
-    RayCollision collision = GetRayCollisionBox(ray, BoundingBox{ {0, 0, 0}, {(float)world->GetWorldSize(), (float)world->GetWorldSize(), (float)world->GetWorldSize()} });
-
-    if (collision.hit) {
-        // Step through the ray in small increments
-        float stepSize = 0.1f;
-        Vector3 currentPos = rayStart;
-        float traveled = 0.0f;
-
-        while (traveled < maxDistance) {
-            currentPos = Vector3Add(rayStart, Vector3Scale(rayDir, traveled));
-
-            // Check block at current position
-            Vector3 checkPos = {
-                floorf(currentPos.x),
-                floorf(currentPos.y),
-                floorf(currentPos.z)
-            };
-
-            if (world->IsBlockAt(checkPos)) {
-                hitPos = currentPos;
-                blockPos = checkPos;
-
-                // Determine which face was hit
-                Vector3 blockCenter = Vector3Add(checkPos, { 0.5f, 0.5f, 0.5f });
-                Vector3 diff = Vector3Subtract(currentPos, blockCenter);
-
-                // Find which face has the largest absolute difference
-                float absX = fabsf(diff.x);
-                float absY = fabsf(diff.y);
-                float absZ = fabsf(diff.z);
-
-                if (absX > absY && absX > absZ) {
-                    normal = { diff.x > 0 ? 1.0f : -1.0f, 0.0f, 0.0f };
-                }
-                else if (absY > absX && absY > absZ) {
-                    normal = { 0.0f, diff.y > 0 ? 1.0f : -1.0f, 0.0f };
-                }
-                else {
-                    normal = { 0.0f, 0.0f, diff.z > 0 ? 1.0f : -1.0f };
-                }
-
-                return true;
-            }
-
-            traveled += stepSize;
-        }
+    // Simulation state, not the interpolated camera, so interaction is deterministic
+    RaycastHit hit;
+    if (!world->Raycast(GetEyePosition(), GetLookVector(), maxDistance, hit)) {
+        return false;
     }
 
-    return false;
+    hitPos = hit.point;
+    normal = hit.normal;
+    blockPos = hit.blockPos;
+    return true;
 }
 
 void Character::Draw() {
@@ -380,59 +391,120 @@ bool Character::BoxCollision(const Vector3& box1Min, const Vector3& box1Max,
 bool Character::CheckCollision(const Vector3& newPos) const {
     if (!world) return false;
 
+    // Every cell overlapped by the box, not just its corners
     Vector3 halfSize = Vector3Scale(size, 0.5f);
-    Vector3 newBoxMin = { newPos.x - halfSize.x, newPos.y, newPos.z - halfSize.z };
-    Vector3 newBoxMax = { newPos.x + halfSize.x, newPos.y + size.y, newPos.z + halfSize.z };
-
-    // Check 9 key points in the bounding box (corners + center)
-    std::vector<Vector3> checkPoints = {
-        newBoxMin,
-        {newBoxMax.x, newBoxMin.y, newBoxMin.z},
-        {newBoxMin.x, newBoxMin.y, newBoxMax.z},
-        {newBoxMax.x, newBoxMin.y, newBoxMax.z},
-        {newBoxMin.x, newBoxMax.y, newBoxMin.z},
-        {newBoxMax.x, newBoxMax.y, newBoxMin.z},
-        {newBoxMin.x, newBoxMax.y, newBoxMax.z},
-        newBoxMax,
-        {newPos.x, newPos.y + size.y / 2, newPos.z}
-    };
-
-    for (const auto& point : checkPoints) {
-        if (world->IsBlockAt(point)) {
-            return true;
+    int minX = (int)floorf(newPos.x - halfSize.x + COLLISION_EPSILON);
+    int maxX = (int)floorf(newPos.x + halfSize.x - COLLISION_EPSILON);
+    int minY = (int)floorf(newPos.y + COLLISION_EPSILON);
+    int maxY = (int)floorf(newPos.y + size.y - COLLISION_EPSILON);
+    int minZ = (int)floorf(newPos.z - halfSize.z + COLLISION_EPSILON);
+    int maxZ = (int)floorf(newPos.z + halfSize.z - COLLISION_EPSILON);
+
+    const Vector3 boxMin = { newPos.x - halfSize.x + COLLISION_EPSILON, newPos.y + COLLISION_EPSILON, newPos.z - halfSize.z + COLLISION_EPSILON };
+    const Vector3 boxMax = { newPos.x + halfSize.x - COLLISION_EPSILON, newPos.y + size.y - COLLISION_EPSILON, newPos.z + halfSize.z - COLLISION_EPSILON };
+
+    for (int y = minY; y <= maxY; y++) {
+        for (int z = minZ; z <= maxZ; z++) {
+            for (int x = minX; x <= maxX; x++) {
+                BoundingBox cell;
+                if (GetCellBox(x, y, z, cell) && BoxCollision(boxMin, boxMax, cell.min, cell.max)) return true;
+            }
         }
     }
 
     return false;
 }
 
-Vector3 Character::ResolveCollision(const Vector3& newPos) const {
-    Vector3 resolvedPos = position;
+CollisionResult Character::MoveAndCollide(const Vector3& startPos, const Vector3& displacement) const {
+    Vector3 halfSize = Vector3Scale(size, 0.5f);
+    Vector3 boxMin = { startPos.x - halfSize.x, startPos.y, startPos.z - halfSize.z };
+    Vector3 boxMax = { startPos.x + halfSize.x, startPos.y + size.y, startPos.z + halfSize.z };
+
+    CollisionResult result = { startPos, { 0.0f, 0.0f, 0.0f } };
+    if (!world) {
+        result.position = Vector3Add(startPos, displacement);
+        return result;
+    }
+
+    // Vertical first so landing is settled before sliding along walls
+    const int axisOrder[3] = { 1, 0, 2 };
+    Vector3 delta = displacement;
+
+    for (int axis : axisOrder) {
+        float wanted = Axis(delta, axis);
+        if (wanted == 0.0f) continue;
 
-    // Try X
-    Vector3 testPosX = resolvedPos;
-    testPosX.x = newPos.x;
-    if (!CheckCollision(testPosX)) {
-        resolvedPos.x = newPos.x;
+        float moved = SweepAxis(boxMin, boxMax, axis, wanted);
+        if (moved != wanted) {
+            Axis(result.normal, axis) = wanted > 0.0f ? -1.0f : 1.0f;
+        }
     }
 
-    // Try Z
-    Vector3 testPosZ = resolvedPos;
-    testPosZ.z = newPos.z;
-    if (!CheckCollision(testPosZ)) {
-        resolvedPos.z = newPos.z;
+    result.position = { boxMin.x + halfSize.x, boxMin.y, boxMin.z + halfSize.z };
+    return result;
+}
+
+float Character::SweepAxis(Vector3& boxMin, Vector3& boxMax, int axis, float distance) const {
+    // Cell range covered by the box on the two other axes
+    int lo[3], hi[3];
+    for (int a = 0; a < 3; a++) {
+        lo[a] = (int)floorf(Axis(boxMin, a) + COLLISION_EPSILON);
+        hi[a] = (int)floorf(Axis(boxMax, a) - COLLISION_EPSILON);
     }
 
-    // Try Y
-    Vector3 testPosY = resolvedPos;
-    testPosY.y = newPos.y;
-    if (!CheckCollision(testPosY)) {
-        resolvedPos.y = newPos.y;
+    // Walk the layers of cells the leading face passes through, nearest first. The layer
+    // it starts in is included, since a partial block there can still be ahead of it.
+    int first, last, step;
+    if (distance > 0.0f) {
+        first = (int)floorf(Axis(boxMax, axis) - COLLISION_EPSILON);
+        last = (int)floorf(Axis(boxMax, axis) + distance - COLLISION_EPSILON);
+        step = 1;
     }
-    else if (newPos.y < resolvedPos.y) {
-        // Landing on ground
-        resolvedPos.y = floorf(newPos.y) + 1.01f;
+    else {
+        first = (int)floorf(Axis(boxMin, axis) + COLLISION_EPSILON);
+        last = (int)floorf(Axis(boxMin, axis) + distance);
+        step = -1;
+    }
+
+    const float wanted = distance;
+    for (int layer = first; step > 0 ? layer <= last : layer >= last; layer += step) {
+        lo[axis] = hi[axis] = layer;
+
+        for (int y = lo[1]; y <= hi[1]; y++) {
+            for (int z = lo[2]; z <= hi[2]; z++) {
+                for (int x = lo[0]; x <= hi[0]; x++) {
+                    BoundingBox cell;
+                    if (!GetCellBox(x, y, z, cell)) continue;
+
+                    // Must overlap the box on the other two axes
+                    bool overlaps = true;
+                    for (int a = 0; a < 3; a++) {
+                        if (a == axis) continue;
+                        overlaps = overlaps && Axis(cell.min, a) < Axis(boxMax, a) - COLLISION_EPSILON
+                            && Axis(cell.max, a) > Axis(boxMin, a) + COLLISION_EPSILON;
+                    }
+                    if (!overlaps) continue;
+
+                    // Stop flush against the near face of whatever lies ahead
+                    if (step > 0 && Axis(cell.min, axis) >= Axis(boxMax, axis) - COLLISION_EPSILON) {
+                        distance = std::min(distance, Axis(cell.min, axis) - Axis(boxMax, axis));
+                    }
+                    else if (step < 0 && Axis(cell.max, axis) <= Axis(boxMin, axis) + COLLISION_EPSILON) {
+                        distance = std::max(distance, Axis(cell.max, axis) - Axis(boxMin, axis));
+                    }
+                }
+            }
+        }
+
+        // Later layers are all further away
+        if (distance != wanted) break;
     }
 
-    return resolvedPos;
+    Axis(boxMin, axis) += distance;
+    Axis(boxMax, axis) += distance;
+    return distance;
+}
+
+bool Character::GetCellBox(int x, int y, int z, BoundingBox& box) const {
+    return world->GetCollisionBox(x, y, z, box);
 }
\ No newline at end of file
@@ -9,10 +9,35 @@
 // Forward declaration
 class OptimizedWorld;
 
+// Outcome of sweeping the player box through the voxel grid
+struct CollisionResult {
+    Vector3 position;
+    Vector3 normal;  // Contact normal per axis (-1, 0 or 1), zero where the axis moved freely
+};
+
+// Player input for one simulation tick. Held keys are sampled every frame, presses
+// are latched until a tick consumes them; recording one per tick gives a replayable stream.
+struct PlayerInput {
+    float yaw;
+    float pitch;
+    bool forward, back, left, right;
+    bool up, down;        // Fly up/down
+    bool sprint;
+    bool breakHeld;
+    int selectedBlock;
+
+    // Edge-triggered, cleared after each tick
+    bool jump;
+    bool toggleFly;
+    bool breakReleased;
+    bool place;
+};
+
 class Character {
 private:
     // Character properties
     Vector3 position;
+    Vector3 previousPosition;  // Position at the previous tick, for render interpolation
     Vector3 velocity;
     Vector3 size;
     float speed;
@@ -28,6 +53,11 @@ private:
     float cameraYaw;
     float mouseSensitivity;
 
+    // Simulation input: latched between ticks, and the look angles of the last tick
+    PlayerInput input;
+    float lookPitch;
+    float lookYaw;
+
     // Movement states
     bool isWalking;
     bool isRunning;
@@ -49,7 +79,15 @@ public:
     Character(OptimizedWorld* worldRef, Vector3 startPos = { 0, 10, 0 });
     ~Character() = default;
 
-    void Update();
+    // Per frame: mouse look and key sampling
+    void PollInput();
+    // Fixed-rate simulation step using the latched input
+    void Tick(float dt);
+    // Deterministic simulation step for a given input
+    void Simulate(const PlayerInput& tickInput, float dt);
+    // Per frame: place the camera between the last two ticks (alpha in [0, 1])
+    void UpdateCamera(float alpha);
+
     void Draw();
     void DrawHUD();
 
@@ -57,10 +95,11 @@ public:
     Vector3 GetPosition() const { return position; }
     Vector3 GetCameraPosition() const { return camera.position; }
     Vector3 GetForwardVector();
+    Vector3 GetEyePosition() const;
     Vector3 GetTargetPosition(float distance = 5.0f);
 
     int GetSelectedBlock() const { return selectedBlockType; }
-    void SetSelectedBlock(int type) { selectedBlockType = type; }
+    void SetSelectedBlock(int type) { selectedBlockType = type; input.selectedBlock = type; }
 
     bool IsGrounded() const { return isGrounded; }
     bool IsRunning() const { return isRunning; }
@@ -72,17 +111,20 @@ public:
 
     // Collision methods
     bool CheckCollision(const Vector3& newPos) const;
-    Vector3 ResolveCollision(const Vector3& newPos) const;
+    CollisionResult MoveAndCollide(const Vector3& startPos, const Vector3& displacement) const;
 
 private:
-    void HandleInput();
-    void UpdateCamera();
-    void UpdatePhysics();
-    void UpdateCameraBobbing();
+    void HandleInput(const PlayerInput& tickInput);
+    void UpdatePhysics(float dt);
+    void UpdateCameraBobbing(float dt);
+    Vector3 GetLookVector() const;
 
-    // Collision helper
+    // Collision helpers
     bool BoxCollision(const Vector3& box1Min, const Vector3& box1Max,
         const Vector3& box2Min, const Vector3& box2Max) const;
+    float SweepAxis(Vector3& boxMin, Vector3& boxMax, int axis, float distance) const;
+    // Solid part of a cell; partial blocks such as slabs only fill some of it
+    bool GetCellBox(int x, int y, int z, BoundingBox& box) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "ChunkIO.hpp"
+#include "World.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <unordered_set>
+
+namespace {
+    // Weight of the newest sample in the latency averages
+    const float LATENCY_SMOOTHING = 0.1f;
+
+    float ToMilliseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<float, std::milli>(duration).count();
+    }
+}
+
+ChunkIO::ChunkIO(const std::string& saveDirectory, bool mapReads)
+    : directory(saveDirectory), store(saveDirectory, REGION_COMPRESSED, mapReads),
+    journal((std::filesystem::path(saveDirectory) / "journal.rcj").string()), regionWriteFailed(false),
+    focusX(0), focusZ(0), nextSequence(0), busy(false), stopping(false), stats{} {
+    thread = std::thread(&ChunkIO::WorkerLoop, this);
+}
+
+ChunkIO::~ChunkIO() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        reads.clear();
+    }
+    wakeWorker.notify_one();
+    thread.join();
+}
+
+void ChunkIO::RequestRead(Chunk* chunk, bool allowMapping, ReadCallback callback) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const int distance = std::max(abs(chunk->x - focusX), abs(chunk->z - focusZ));
+        reads.push_back({ chunk, chunk->x, chunk->z, distance, nextSequence++, allowMapping, Clock::now(), std::move(callback) });
+        std::push_heap(reads.begin(), reads.end(), IsFartherThan);
+    }
+    wakeWorker.notify_one();
+}
+
+bool ChunkIO::CancelRead(Chunk* chunk) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto request = std::find_if(reads.begin(), reads.end(), [&](const ReadRequest& read) { return read.chunk == chunk; });
+    if (request == reads.end()) return false;
+
+    *request = std::move(reads.back());
+    reads.pop_back();
+    std::make_heap(reads.begin(), reads.end(), IsFartherThan);
+    return true;
+}
+
+void ChunkIO::QueueWrite(std::vector<Chunk*> chunks, RegionFormat format, WriteCallback callback) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unordered_set<long long> regions;
+        for (const Chunk* chunk : chunks) {
+            regions.insert(RegionStore::GetRegionKey(chunk->x, chunk->z));
+        }
+        for (long long region : regions) {
+            regionWrites[region]++;
+        }
+        writes.push_back({ WRITE_CHUNKS, std::move(chunks), format, {}, Clock::now(), std::move(callback) });
+    }
+    wakeWorker.notify_one();
+}
+
+void ChunkIO::AppendJournal(std::vector<JournalEdit> edits) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        writes.push_back({ WRITE_JOURNAL_APPEND, {}, REGION_COMPRESSED, std::move(edits), Clock::now(), nullptr });
+    }
+    wakeWorker.notify_one();
+}
+
+void ChunkIO::CompactJournal(std::vector<JournalEdit> keptEdits) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        writes.push_back({ WRITE_JOURNAL_COMPACT, {}, REGION_COMPRESSED, std::move(keptEdits), Clock::now(), nullptr });
+    }
+    wakeWorker.notify_one();
+}
+
+void ChunkIO::SetFocus(int chunkX, int chunkZ) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (chunkX == focusX && chunkZ == focusZ) return;
+
+    focusX = chunkX;
+    focusZ = chunkZ;
+    for (ReadRequest& read : reads) {
+        read.distance = std::max(abs(read.chunkX - focusX), abs(read.chunkZ - focusZ));
+    }
+    std::make_heap(reads.begin(), reads.end(), IsFartherThan);
+}
+
+void ChunkIO::Poll() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (completions.empty()) return;
+
+        // A region queued for rewriting will lose its mapping, so nothing may go live pointing into it
+        if (!regionWrites.empty()) {
+            for (const Completion& completion : completions) {
+                if (completion.chunk && completion.chunk->IsMapped()
+                    && regionWrites.count(RegionStore::GetRegionKey(completion.chunk->x, completion.chunk->z))) {
+                    completion.chunk->Unmap();
+                }
+            }
+        }
+        delivering.swap(completions);
+    }
+
+    for (Completion& completion : delivering) {
+        completion.deliver();
+    }
+    delivering.clear();
+}
+
+void ChunkIO::Flush() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        queueDrained.wait(lock, [&] { return reads.empty() && writes.empty() && !busy; });
+    }
+    Poll();
+}
+
+ChunkIOStats ChunkIO::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ChunkIOStats current = stats;
+    current.queuedReads = (int)reads.size();
+    current.queuedWrites = 0;
+    for (const WriteRequest& write : writes) {
+        current.queuedWrites += (int)write.chunks.size();
+    }
+    return current;
+}
+
+void ChunkIO::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeWorker.wait(lock, [&] { return stopping || !reads.empty() || !writes.empty(); });
+        if (stopping && writes.empty()) break;
+
+        // Reads keep the world around the player filling in; writes only need to land eventually
+        if (!reads.empty()) {
+            RunRead(lock);
+        }
+        else if (writes.front().kind == WRITE_CHUNKS) {
+            RunWrites(lock);
+        }
+        else {
+            RunJournal(lock);
+        }
+
+        if (reads.empty() && writes.empty()) {
+            queueDrained.notify_all();
+        }
+    }
+}
+
+void ChunkIO::RunRead(std::unique_lock<std::mutex>& lock) {
+    std::pop_heap(reads.begin(), reads.end(), IsFartherThan);
+    ReadRequest read = std::move(reads.back());
+    reads.pop_back();
+    busy = true;
+
+    lock.unlock();
+    const bool found = store.ReadChunk(*read.chunk, read.allowMapping);
+    lock.lock();
+
+    const float latency = ToMilliseconds(Clock::now() - read.queued);
+    stats.readsDone++;
+    stats.readLatency += (latency - stats.readLatency) * LATENCY_SMOOTHING;
+    stats.readLatencyPeak = std::max(stats.readLatencyPeak, latency);
+
+    Chunk* chunk = read.chunk;
+    completions.push_back({ chunk, [callback = std::move(read.callback), chunk, found] { callback(chunk, found); } });
+    busy = false;
+}
+
+void ChunkIO::RunWrites(std::unique_lock<std::mutex>& lock) {
+    // Batches queued behind each other become one rewrite per region file; a chunk in
+    // several of them is written from its latest copy
+    std::vector<WriteRequest> batch;
+    batch.push_back(std::move(writes.front()));
+    writes.pop_front();
+    while (!writes.empty() && writes.front().kind == WRITE_CHUNKS && writes.front().format == batch.front().format) {
+        batch.push_back(std::move(writes.front()));
+        writes.pop_front();
+    }
+    busy = true;
+
+    std::unordered_map<long long, Chunk*> latest;
+    std::unordered_set<long long> regions;
+    for (const WriteRequest& write : batch) {
+        for (Chunk* chunk : write.chunks) {
+            latest[((long long)chunk->x << 32) | (unsigned int)chunk->z] = chunk;
+            regions.insert(RegionStore::GetRegionKey(chunk->x, chunk->z));
+        }
+    }
+    std::vector<const Chunk*> chunks;
+    chunks.reserve(latest.size());
+    for (const auto& [key, chunk] : latest) {
+        chunks.push_back(chunk);
+    }
+
+    // Reads finished but not yet handed over may still point into the files about to be replaced
+    for (const Completion& completion : completions) {
+        if (completion.chunk && completion.chunk->IsMapped()
+            && regions.count(RegionStore::GetRegionKey(completion.chunk->x, completion.chunk->z))) {
+            completion.chunk->Unmap();
+        }
+    }
+
+    lock.unlock();
+    for (const auto& [key, chunk] : latest) {
+        chunk->ResolveSnapshot();
+    }
+    store.SetFormat(batch.front().format);
+    const bool success = store.WriteChunks(chunks);
+    lock.lock();
+    if (!success) regionWriteFailed = true;
+
+    const Clock::time_point now = Clock::now();
+    for (WriteRequest& write : batch) {
+        std::unordered_set<long long> writeRegions;
+        for (const Chunk* chunk : write.chunks) {
+            writeRegions.insert(RegionStore::GetRegionKey(chunk->x, chunk->z));
+        }
+        for (long long region : writeRegions) {
+            if (--regionWrites[region] == 0) regionWrites.erase(region);
+        }
+
+        stats.writesDone += (int)write.chunks.size();
+        stats.writeLatency += (ToMilliseconds(now - write.queued) - stats.writeLatency) * LATENCY_SMOOTHING;
+        completions.push_back({ nullptr, [callback = std::move(write.callback), success] { callback(success); } });
+    }
+    busy = false;
+}
+
+void ChunkIO::RunJournal(std::unique_lock<std::mutex>& lock) {
+    WriteRequest write = std::move(writes.front());
+    writes.pop_front();
+    busy = true;
+
+    // A failed region write may have lost edits that only the journal still has
+    const bool compact = write.kind == WRITE_JOURNAL_COMPACT && !regionWriteFailed;
+    lock.unlock();
+    if (write.kind == WRITE_JOURNAL_APPEND) {
+        journal.Append(write.edits);
+    }
+    else if (compact) {
+        journal.Rewrite(write.edits);
+    }
+    lock.lock();
+
+    if (write.kind == WRITE_JOURNAL_COMPACT) regionWriteFailed = false;
+    stats.journalEdits = journal.GetRecordCount();
+    busy = false;
+}
+
+bool ChunkIO::IsFartherThan(const ReadRequest& a, const ReadRequest& b) {
+    // Equal distances keep request order
+    if (a.distance != b.distance) return a.distance > b.distance;
+    return a.sequence > b.sequence;
+}
@@ -0,0 +1,144 @@
+#ifndef CHUNK_IO_HPP
+#define CHUNK_IO_HPP
+
+#include "RegionStore.hpp"
+#include "EditJournal.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct Chunk;
+
+// Queue depth and latency counters shown in the debug overlay
+struct ChunkIOStats {
+    int queuedReads;
+    int queuedWrites;        // Chunks waiting in write batches
+    int readsDone;
+    int writesDone;          // Chunks written
+    int journalEdits;        // Edits in the journal file
+    float readLatency;       // Moving average from request to result, in ms
+    float readLatencyPeak;
+    float writeLatency;      // Moving average per batch, in ms
+};
+
+// Runs every region and journal file access on one background thread so the frame loop
+// never waits on the disk. Reads are served nearest to the focus chunk first and can be
+// cancelled until they start. Writes run in the order they were queued: batches of chunk
+// copies, merged with batches queued right behind them so each region file is rewritten
+// once, journal appends and journal compactions. Finished requests wait until Poll runs
+// their callbacks on the main thread.
+// A chunk handed to the queue belongs to the I/O thread until its callback runs.
+class ChunkIO {
+public:
+    using ReadCallback = std::function<void(Chunk* chunk, bool found)>;
+    using WriteCallback = std::function<void(bool success)>;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct ReadRequest {
+        Chunk* chunk;
+        int chunkX, chunkZ;
+        int distance;            // Rings from the focus chunk
+        unsigned long long sequence;
+        bool allowMapping;
+        Clock::time_point queued;
+        ReadCallback callback;
+    };
+
+    enum WriteKind {
+        WRITE_CHUNKS,
+        WRITE_JOURNAL_APPEND,
+        WRITE_JOURNAL_COMPACT
+    };
+
+    struct WriteRequest {
+        WriteKind kind;
+        std::vector<Chunk*> chunks;
+        RegionFormat format;
+        std::vector<JournalEdit> edits;  // Appended, or kept by the compaction
+        Clock::time_point queued;
+        WriteCallback callback;
+    };
+
+    struct Completion {
+        Chunk* chunk;            // Read target, null for writes
+        std::function<void()> deliver;
+    };
+
+    std::string directory;
+    RegionStore store;     // Only touched by the I/O thread
+    EditJournal journal;   // Likewise
+    bool regionWriteFailed;  // Since the last compaction, which then keeps the journal
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wakeWorker;
+    std::condition_variable queueDrained;
+
+    std::vector<ReadRequest> reads;  // Heap, nearest first
+    std::deque<WriteRequest> writes;
+    std::vector<Completion> completions;
+    std::vector<Completion> delivering;
+
+    // Writes queued or running per region. Their files are about to be replaced, so read
+    // results from them are copied out of the old mapping before they are handed over.
+    std::unordered_map<long long, int> regionWrites;
+
+    int focusX, focusZ;
+    unsigned long long nextSequence;
+    bool busy;
+    bool stopping;
+    ChunkIOStats stats;
+
+public:
+    ChunkIO(const std::string& saveDirectory, bool mapReads);
+    // Finishes the queued writes; reads and undelivered callbacks are dropped
+    ~ChunkIO();
+
+    ChunkIO(const ChunkIO&) = delete;
+    ChunkIO& operator=(const ChunkIO&) = delete;
+
+    // Fills a freshly acquired chunk from disk. found is false if the chunk was never
+    // saved or its record is damaged, and the chunk is left for the caller to generate.
+    void RequestRead(Chunk* chunk, bool allowMapping, ReadCallback callback);
+    // True if the read had not started; the chunk is the caller's again and its
+    // callback never runs. Otherwise the callback still comes.
+    bool CancelRead(Chunk* chunk);
+
+    // Stores the chunks, which stay untouched until the callback runs; snapshots taken with
+    // Chunk::SnapshotFrom are resolved right before they are encoded. The caller must first
+    // stop its live chunks from pointing into the mappings of the regions written.
+    void QueueWrite(std::vector<Chunk*> chunks, RegionFormat format, WriteCallback callback);
+
+    // Logs edits behind everything queued so far
+    void AppendJournal(std::vector<JournalEdit> edits);
+    // Once every region write queued before it has succeeded, the journal is rewritten
+    // with only the given edits, which must be all those not yet in a region file
+    void CompactJournal(std::vector<JournalEdit> keptEdits);
+
+    // Reads closer to this chunk go first
+    void SetFocus(int chunkX, int chunkZ);
+
+    // Runs the callbacks of finished requests on the calling thread
+    void Poll();
+    // Waits for every queued request and runs its callback; for switching worlds and shutdown
+    void Flush();
+
+    const std::string& GetDirectory() const { return directory; }
+    ChunkIOStats GetStats();
+
+private:
+    void WorkerLoop();
+    void RunRead(std::unique_lock<std::mutex>& lock);
+    void RunWrites(std::unique_lock<std::mutex>& lock);
+    void RunJournal(std::unique_lock<std::mutex>& lock);
+    static bool IsFartherThan(const ReadRequest& a, const ReadRequest& b);
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "ChunkPool.hpp"
+#include "World.hpp"
+#include <algorithm>
+#include <new>
+
+namespace {
+    // Block buffers start on a cache line
+    const std::align_val_t BLOCK_ALIGNMENT = std::align_val_t(64);
+}
+
+struct ChunkPool::Slab {
+    int count;
+    Block* blocks;
+    Chunk* chunks;
+
+    explicit Slab(int chunkCount) : count(chunkCount) {
+        blocks = static_cast<Block*>(::operator new(sizeof(Block) * CHUNK_VOLUME * count, BLOCK_ALIGNMENT));
+        chunks = static_cast<Chunk*>(::operator new(sizeof(Chunk) * count));
+        for (int i = 0; i < count; i++) {
+            new (&chunks[i]) Chunk(blocks + (size_t)i * CHUNK_VOLUME);
+        }
+    }
+
+    bool Contains(const Chunk* chunk) const {
+        return chunk >= chunks && chunk < chunks + count;
+    }
+
+    ~Slab() {
+        for (int i = 0; i < count; i++) {
+            chunks[i].~Chunk();
+        }
+        ::operator delete(chunks);
+        ::operator delete(blocks, BLOCK_ALIGNMENT);
+    }
+};
+
+ChunkPool::ChunkPool() : capacity(0), inUse(0), highWaterMark(0) {
+}
+
+ChunkPool::~ChunkPool() {
+}
+
+void ChunkPool::Reserve(int count) {
+    if ((int)freeChunks.size() < count) {
+        AddSlab(count - (int)freeChunks.size());
+    }
+}
+
+Chunk* ChunkPool::Acquire(int chunkX, int chunkZ) {
+    if (freeChunks.empty()) {
+        AddSlab(SLAB_CHUNKS);
+    }
+
+    // Most recently released first, its blocks are most likely still cached
+    Chunk* chunk = freeChunks.back();
+    freeChunks.pop_back();
+    chunk->Reset(chunkX, chunkZ);
+
+    inUse++;
+    if (inUse > highWaterMark) highWaterMark = inUse;
+    return chunk;
+}
+
+Chunk* ChunkPool::AcquireContiguous(int count) {
+    // Chunks already on the free list may come from any slab in any order, so the run
+    // is taken from a slab of its own, typically the one a reloaded world gave back
+    Slab* slab = nullptr;
+    for (const auto& candidate : slabs) {
+        if (candidate->count == count && std::count_if(freeChunks.begin(), freeChunks.end(),
+            [&](const Chunk* chunk) { return candidate->Contains(chunk); }) == count) {
+            slab = candidate.get();
+            break;
+        }
+    }
+
+    if (slab) {
+        freeChunks.erase(std::remove_if(freeChunks.begin(), freeChunks.end(),
+            [&](const Chunk* chunk) { return slab->Contains(chunk); }), freeChunks.end());
+    }
+    else {
+        slabs.push_back(std::make_unique<Slab>(count));
+        slab = slabs.back().get();
+        capacity += count;
+        freeChunks.reserve(capacity);
+    }
+
+    inUse += count;
+    if (inUse > highWaterMark) highWaterMark = inUse;
+    return slab->chunks;
+}
+
+void ChunkPool::Release(Chunk* chunk) {
+    chunk->UnloadMeshes();
+    freeChunks.push_back(chunk);
+    inUse--;
+}
+
+size_t ChunkPool::GetMemory() const {
+    return (size_t)capacity * (sizeof(Chunk) + sizeof(Block) * CHUNK_VOLUME);
+}
+
+void ChunkPool::AddSlab(int chunkCount) {
+    slabs.push_back(std::make_unique<Slab>(chunkCount));
+    Slab& slab = *slabs.back();
+    capacity += chunkCount;
+
+    // Room for every chunk the pool owns, so Release never reallocates
+    freeChunks.reserve(capacity);
+    for (int i = chunkCount - 1; i >= 0; i--) {
+        freeChunks.push_back(&slab.chunks[i]);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef CHUNK_POOL_HPP
+#define CHUNK_POOL_HPP
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+struct Chunk;
+
+// Hands out chunks from slabs allocated SLAB_CHUNKS at a time. Each slab holds the
+// chunk objects and one contiguous block buffer for all of them; released chunks go
+// on a free list and are reset on reuse, so streaming stops allocating once the pool
+// has grown to the window size.
+class ChunkPool {
+public:
+    static const int SLAB_CHUNKS = 64;
+
+private:
+    struct Slab;
+    std::vector<std::unique_ptr<Slab>> slabs;
+    std::vector<Chunk*> freeChunks;
+    int capacity;
+    int inUse;
+    int highWaterMark;
+
+public:
+    ChunkPool();
+    ~ChunkPool();
+
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+
+    // Makes sure count more chunks can be acquired without growing. Any shortfall is
+    // added as one slab, whose chunks are handed out next and in storage order.
+    void Reserve(int count);
+
+    // Returns a reset chunk at the given chunk coordinates. Its blocks are whatever the
+    // buffer last held; the caller generates or loads over them.
+    Chunk* Acquire(int chunkX, int chunkZ);
+    // Returns an array of count chunks whose blocks are one contiguous buffer, in array
+    // order. A slab of exactly that size with every chunk free is reused, otherwise a new
+    // one is added. The chunks are not reset; each goes back through Release.
+    Chunk* AcquireContiguous(int count);
+    void Release(Chunk* chunk);
+
+    int GetInUse() const { return inUse; }
+    int GetCapacity() const { return capacity; }
+    int GetHighWaterMark() const { return highWaterMark; }
+    size_t GetMemory() const;
+
+private:
+    void AddSlab(int chunkCount);
+};
+
+#endif
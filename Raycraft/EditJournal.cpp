@@ -0,0 +1,158 @@
+#include "EditJournal.hpp"
+#include "World.hpp"
+#include "raylib.h"
+#include <cstring>
+#include <filesystem>
+
+namespace {
+    const uint32_t JOURNAL_MAGIC = 0x4C4A4352;  // "RCJL"
+    const uint32_t JOURNAL_VERSION = 1;
+
+    struct JournalHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t chunkSize;
+        uint32_t worldHeight;
+    };
+
+    struct FrameHeader {
+        uint32_t count;
+        uint32_t crc;
+    };
+
+    const int RECORD_BYTES = 12;
+    const int INDEX_BITS = 20;
+    const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static_assert(CHUNK_VOLUME <= (1 << INDEX_BITS), "Block indices must fit the journal record");
+
+    void EncodeFrame(const std::vector<JournalEdit>& edits, std::vector<unsigned char>& output) {
+        output.resize(sizeof(FrameHeader) + edits.size() * RECORD_BYTES);
+        unsigned char* record = output.data() + sizeof(FrameHeader);
+        for (const JournalEdit& edit : edits) {
+            const int32_t position[2] = { edit.chunkX, edit.chunkZ };
+            const uint32_t packed = (uint32_t)edit.index | (uint32_t)(edit.state & BLOCK_STATE_MASK) << INDEX_BITS
+                | (uint32_t)edit.type << 24;
+            memcpy(record, position, sizeof(position));
+            memcpy(record + sizeof(position), &packed, sizeof(packed));
+            record += RECORD_BYTES;
+        }
+
+        FrameHeader header = { (uint32_t)edits.size(), 0 };
+        header.crc = ComputeCRC32(output.data() + sizeof(FrameHeader), (int)(edits.size() * RECORD_BYTES));
+        memcpy(output.data(), &header, sizeof(header));
+    }
+}
+
+EditJournal::EditJournal(const std::string& journalPath)
+    : path(journalPath), recordCount(0), opened(false) {
+}
+
+bool EditJournal::Append(const std::vector<JournalEdit>& edits) {
+    if (edits.empty()) return true;
+    if (!opened && !Open()) return false;
+
+    std::vector<unsigned char> frame;
+    EncodeFrame(edits, frame);
+    file.write((const char*)frame.data(), (std::streamsize)frame.size());
+    file.flush();
+    if (!file) {
+        TraceLog(LOG_WARNING, "JOURNAL: Failed to append to %s", path.c_str());
+        return false;
+    }
+    recordCount += (int)edits.size();
+    return true;
+}
+
+bool EditJournal::Rewrite(const std::vector<JournalEdit>& edits) {
+    file.close();
+    opened = false;
+
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+        const JournalHeader header = { JOURNAL_MAGIC, JOURNAL_VERSION, CHUNK_SIZE, WORLD_HEIGHT };
+        output.write((const char*)&header, sizeof(header));
+        if (!edits.empty()) {
+            std::vector<unsigned char> frame;
+            EncodeFrame(edits, frame);
+            output.write((const char*)frame.data(), (std::streamsize)frame.size());
+        }
+        if (!output) {
+            TraceLog(LOG_WARNING, "JOURNAL: Failed to write %s", temporaryPath.c_str());
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        TraceLog(LOG_WARNING, "JOURNAL: Failed to replace %s", path.c_str());
+        return false;
+    }
+
+    file.open(path, std::ios::binary | std::ios::app);
+    opened = (bool)file;
+    recordCount = (int)edits.size();
+    return opened;
+}
+
+bool EditJournal::Open() {
+    // Anything after the last intact frame is dropped, so new frames are not appended
+    // behind a torn one
+    std::vector<JournalEdit> edits;
+    uint64_t validBytes = 0;
+    if (!Read(path, edits, &validBytes)) {
+        return Rewrite(edits);
+    }
+
+    std::error_code error;
+    if (std::filesystem::file_size(path, error) != validBytes) {
+        std::filesystem::resize_file(path, validBytes, error);
+    }
+    file.open(path, std::ios::binary | std::ios::app);
+    opened = (bool)file;
+    recordCount = (int)edits.size();
+    return opened;
+}
+
+bool EditJournal::Read(const std::string& journalPath, std::vector<JournalEdit>& edits, uint64_t* validBytes) {
+    std::ifstream input(journalPath, std::ios::binary);
+    JournalHeader header = {};
+    if (!input.read((char*)&header, sizeof(header)) || header.magic != JOURNAL_MAGIC || header.version != JOURNAL_VERSION
+        || header.chunkSize != CHUNK_SIZE || header.worldHeight != WORLD_HEIGHT) {
+        return false;
+    }
+
+    std::error_code error;
+    const uint64_t fileSize = std::filesystem::file_size(journalPath, error);
+    uint64_t offset = sizeof(header);
+    std::vector<unsigned char> records;
+    FrameHeader frame;
+    while (input.read((char*)&frame, sizeof(frame))) {
+        const uint64_t frameBytes = (uint64_t)frame.count * RECORD_BYTES;
+        if (offset + sizeof(frame) + frameBytes > fileSize) {
+            TraceLog(LOG_WARNING, "JOURNAL: %s ends in a torn frame, replaying up to it", journalPath.c_str());
+            break;
+        }
+        records.resize((size_t)frameBytes);
+        if (!input.read((char*)records.data(), (std::streamsize)records.size())
+            || ComputeCRC32(records.data(), (int)records.size()) != frame.crc) {
+            TraceLog(LOG_WARNING, "JOURNAL: %s ends in a damaged frame, replaying up to it", journalPath.c_str());
+            break;
+        }
+
+        for (uint32_t i = 0; i < frame.count; i++) {
+            const unsigned char* record = records.data() + (size_t)i * RECORD_BYTES;
+            int32_t position[2];
+            uint32_t packed;
+            memcpy(position, record, sizeof(position));
+            memcpy(&packed, record + sizeof(position), sizeof(packed));
+            edits.push_back({ position[0], position[1], (int)(packed & INDEX_MASK),
+                (unsigned char)(packed >> 24), (unsigned char)((packed >> INDEX_BITS) & BLOCK_STATE_MASK) });
+        }
+        offset += sizeof(frame) + records.size();
+    }
+
+    if (validBytes) *validBytes = offset;
+    return true;
+}
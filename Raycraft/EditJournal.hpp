@@ -0,0 +1,56 @@
+#ifndef EDIT_JOURNAL_HPP
+#define EDIT_JOURNAL_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// One block change as it is logged. index is the block's position inside its chunk in
+// y-z-x order, the same order region records use, so it does not depend on the layout.
+struct JournalEdit {
+    int chunkX, chunkZ;
+    int index;
+    unsigned char type;
+    unsigned char state;
+};
+
+// Append-only log of player edits, so saving costs a few bytes per edit instead of a
+// region file rewrite:
+//   header  magic, format version, chunk geometry
+//   frame   record count, CRC32 of the records, then the records
+//   record  chunk x, chunk z, index | state << 20 | type << 24
+// Each append is one frame. A frame cut short by a crash fails its size or checksum
+// check, so replay stops there and the next append starts over it. Once the edits are
+// in the region files the journal is compacted, i.e. rewritten with only the edits that
+// are still nowhere else.
+class EditJournal {
+private:
+    std::string path;
+    std::ofstream file;
+    int recordCount;
+    bool opened;
+
+public:
+    explicit EditJournal(const std::string& journalPath);
+
+    EditJournal(const EditJournal&) = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+
+    // Adds the edits as one frame and hands them to the OS before returning
+    bool Append(const std::vector<JournalEdit>& edits);
+    // Atomically replaces the journal with one holding only these edits
+    bool Rewrite(const std::vector<JournalEdit>& edits);
+
+    // Records in the file, once the journal has been opened by the first write
+    int GetRecordCount() const { return recordCount; }
+
+    // Appends every edit of the intact frames; false if there is no journal of this
+    // version and geometry. validBytes is where the intact part of the file ends.
+    static bool Read(const std::string& journalPath, std::vector<JournalEdit>& edits, uint64_t* validBytes = nullptr);
+
+private:
+    bool Open();
+};
+
+#endif
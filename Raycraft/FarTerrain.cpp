@@ -0,0 +1,264 @@
+#include "FarTerrain.hpp"
+#include "World.hpp"
+#include "rlgl.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+    const int CELL_SIZE = CHUNK_SIZE / FarTerrain::TILE_CELLS;
+}
+
+FarTerrain::FarTerrain()
+    : tiles(WINDOW_SIZE * WINDOW_SIZE), centerX(0), centerZ(0), innerDistance(0), loaded(false),
+    mesh{ 0 }, meshLoaded(false),
+    scratchVertices(VERTICES_PER_TILE * 3), scratchColors(VERTICES_PER_TILE * 4) {
+    for (auto& tile : tiles) {
+        tile.valid = false;
+        tile.hidden = true;
+    }
+}
+
+FarTerrain::~FarTerrain() {
+    Unload();
+}
+
+void FarTerrain::Update(const OptimizedWorld& world, int newCenterX, int newCenterZ, int newInnerDistance) {
+    if (!meshLoaded) {
+        // One zeroed (fully degenerate) vertex range per slot; the CPU copy is only needed for the upload
+        mesh.vertexCount = WINDOW_SIZE * WINDOW_SIZE * VERTICES_PER_TILE;
+        mesh.triangleCount = mesh.vertexCount / 3;
+        mesh.vertices = (float*)RL_CALLOC(mesh.vertexCount * 3, sizeof(float));
+        mesh.colors = (unsigned char*)RL_CALLOC(mesh.vertexCount * 4, sizeof(unsigned char));
+        UploadMesh(&mesh, true);
+        RL_FREE(mesh.vertices);
+        RL_FREE(mesh.colors);
+        mesh.vertices = nullptr;
+        mesh.colors = nullptr;
+        meshLoaded = true;
+        loaded = false;
+    }
+
+    // First load or teleport: refill every tile
+    if (!loaded || abs(newCenterX - centerX) >= WINDOW_SIZE || abs(newCenterZ - centerZ) >= WINDOW_SIZE) {
+        centerX = newCenterX;
+        centerZ = newCenterZ;
+        innerDistance = newInnerDistance;
+
+        for (int tz = centerZ - FAR_DISTANCE; tz <= centerZ + FAR_DISTANCE; tz++) {
+            for (int tx = centerX - FAR_DISTANCE; tx <= centerX + FAR_DISTANCE; tx++) {
+                FillTile(world, tx, tz);
+                GetTile(tx, tz)->hidden = std::max(abs(tx - centerX), abs(tz - centerZ)) <= innerDistance;
+            }
+        }
+        for (int tz = centerZ - FAR_DISTANCE; tz <= centerZ + FAR_DISTANCE; tz++) {
+            for (int tx = centerX - FAR_DISTANCE; tx <= centerX + FAR_DISTANCE; tx++) {
+                UploadTile(tx, tz);
+            }
+        }
+        loaded = true;
+        return;
+    }
+
+    // Step one chunk at a time; each step only touches the edge column/row and the
+    // two rings around the voxel area whose visibility can flip
+    while (centerX != newCenterX) {
+        int step = newCenterX > centerX ? 1 : -1;
+        int entering = centerX + step * (FAR_DISTANCE + 1);
+        centerX += step;
+
+        for (int tz = centerZ - FAR_DISTANCE; tz <= centerZ + FAR_DISTANCE; tz++) {
+            FillTile(world, entering, tz);
+            GetTile(entering, tz)->hidden = false;
+        }
+        // The previous edge column now has a neighbour to stitch to
+        for (int tz = centerZ - FAR_DISTANCE; tz <= centerZ + FAR_DISTANCE; tz++) {
+            UploadTile(entering, tz);
+            UploadTile(entering - step, tz);
+        }
+        UpdateVisibility(innerDistance);
+        UpdateVisibility(innerDistance + 1);
+    }
+
+    while (centerZ != newCenterZ) {
+        int step = newCenterZ > centerZ ? 1 : -1;
+        int entering = centerZ + step * (FAR_DISTANCE + 1);
+        centerZ += step;
+
+        for (int tx = centerX - FAR_DISTANCE; tx <= centerX + FAR_DISTANCE; tx++) {
+            FillTile(world, tx, entering);
+            GetTile(tx, entering)->hidden = false;
+        }
+        for (int tx = centerX - FAR_DISTANCE; tx <= centerX + FAR_DISTANCE; tx++) {
+            UploadTile(tx, entering);
+            UploadTile(tx, entering - step);
+        }
+        UpdateVisibility(innerDistance);
+        UpdateVisibility(innerDistance + 1);
+    }
+
+    while (innerDistance != newInnerDistance) {
+        innerDistance += newInnerDistance > innerDistance ? 1 : -1;
+        UpdateVisibility(innerDistance);
+        UpdateVisibility(innerDistance + 1);
+    }
+}
+
+void FarTerrain::RefineTile(const Chunk& chunk) {
+    Tile* tile = GetTile(chunk.x, chunk.z);
+    if (!tile || tile->refinedVersion == chunk.version) return;
+    tile->refinedVersion = chunk.version;
+
+    for (int j = 0; j < TILE_CELLS; j++) {
+        for (int i = 0; i < TILE_CELLS; i++) {
+            int y = WORLD_HEIGHT - 1;
+            while (y > 0 && chunk.GetBlock(i * CELL_SIZE, y, j * CELL_SIZE).type == BLOCK_AIR) y--;
+
+            tile->heights[j * TILE_CELLS + i] = (unsigned char)y;
+            tile->types[j * TILE_CELLS + i] = chunk.GetBlock(i * CELL_SIZE, y, j * CELL_SIZE).type;
+        }
+    }
+
+    // Tiles on the -X/-Z side borrow this tile's first row and column for their far edge.
+    // Hidden tiles were zeroed when they were hidden and are rebuilt when they reappear.
+    for (int dz = -1; dz <= 0; dz++) {
+        for (int dx = -1; dx <= 0; dx++) {
+            const Tile* neighbor = GetTile(chunk.x + dx, chunk.z + dz);
+            if (neighbor && !neighbor->hidden) {
+                UploadTile(chunk.x + dx, chunk.z + dz);
+            }
+        }
+    }
+}
+
+void FarTerrain::Draw(const Material& material) const {
+    if (meshLoaded && loaded) {
+        DrawMesh(mesh, material, MatrixIdentity());
+    }
+}
+
+void FarTerrain::Unload() {
+    if (meshLoaded) {
+        UnloadMesh(mesh);
+        mesh = { 0 };
+        meshLoaded = false;
+    }
+}
+
+int FarTerrain::GetVisibleTileCount() const {
+    if (!loaded) return 0;
+    return (int)std::count_if(tiles.begin(), tiles.end(),
+        [](const Tile& tile) { return tile.valid && !tile.hidden; });
+}
+
+void FarTerrain::FillTile(const OptimizedWorld& world, int tileX, int tileZ) {
+    Tile& tile = tiles[GetSlot(tileX, tileZ)];
+    tile.x = tileX;
+    tile.z = tileZ;
+    tile.valid = true;
+    tile.refinedVersion = 0;
+
+    // Generator estimate: no voxels, no trees
+    for (int j = 0; j < TILE_CELLS; j++) {
+        for (int i = 0; i < TILE_CELLS; i++) {
+            int height = world.GetTerrainHeight(tileX * CHUNK_SIZE + i * CELL_SIZE, tileZ * CHUNK_SIZE + j * CELL_SIZE);
+            tile.heights[j * TILE_CELLS + i] = (unsigned char)std::clamp(height, 0, WORLD_HEIGHT - 1);
+            tile.types[j * TILE_CELLS + i] = world.GetSurfaceBlock(height).type;
+        }
+    }
+}
+
+void FarTerrain::UploadTile(int tileX, int tileZ) {
+    const Tile* tile = GetTile(tileX, tileZ);
+    if (!tile || !meshLoaded) return;
+
+    if (tile->hidden) {
+        std::fill(scratchVertices.begin(), scratchVertices.end(), 0.0f);
+        std::fill(scratchColors.begin(), scratchColors.end(), (unsigned char)0);
+    }
+    else {
+        const Tile* right = GetTile(tileX + 1, tileZ);
+        const Tile* front = GetTile(tileX, tileZ + 1);
+        const Tile* corner = GetTile(tileX + 1, tileZ + 1);
+
+        // Surface height at grid corner (i, j), borrowing the neighbour's samples past the edge
+        auto height = [&](int i, int j) -> float {
+            const Tile* source = tile;
+            if (i == TILE_CELLS && j == TILE_CELLS && corner) { source = corner; i = 0; j = 0; }
+            else if (i == TILE_CELLS && j < TILE_CELLS && right) { source = right; i = 0; }
+            else if (j == TILE_CELLS && i < TILE_CELLS && front) { source = front; j = 0; }
+            i = std::min(i, TILE_CELLS - 1);
+            j = std::min(j, TILE_CELLS - 1);
+            return source->heights[j * TILE_CELLS + i] + 1.0f;
+        };
+
+        float* vertex = scratchVertices.data();
+        unsigned char* color = scratchColors.data();
+        const float baseX = (float)(tileX * CHUNK_SIZE);
+        const float baseZ = (float)(tileZ * CHUNK_SIZE);
+
+        for (int j = 0; j < TILE_CELLS; j++) {
+            for (int i = 0; i < TILE_CELLS; i++) {
+                float h00 = height(i, j);
+                float h10 = height(i + 1, j);
+                float h01 = height(i, j + 1);
+                float h11 = height(i + 1, j + 1);
+
+                // Darken slopes a little so the relief reads from a distance
+                float slope = fabsf(h10 - h00) + fabsf(h01 - h00);
+                float shade = std::max(0.6f, 1.0f - slope * 0.05f);
+                Color base = Block(tile->types[j * TILE_CELLS + i]).GetColor();
+
+                float x0 = baseX + i * CELL_SIZE, x1 = x0 + CELL_SIZE;
+                float z0 = baseZ + j * CELL_SIZE, z1 = z0 + CELL_SIZE;
+                const float quad[4][3] = { { x0, h00, z0 }, { x0, h01, z1 }, { x1, h11, z1 }, { x1, h10, z0 } };
+                const int order[6] = { 0, 1, 2, 0, 2, 3 };
+
+                for (int k = 0; k < 6; k++) {
+                    *vertex++ = quad[order[k]][0];
+                    *vertex++ = quad[order[k]][1];
+                    *vertex++ = quad[order[k]][2];
+                    *color++ = (unsigned char)(base.r * shade);
+                    *color++ = (unsigned char)(base.g * shade);
+                    *color++ = (unsigned char)(base.b * shade);
+                    *color++ = 255;
+                }
+            }
+        }
+    }
+
+    int firstVertex = GetSlot(tileX, tileZ) * VERTICES_PER_TILE;
+    UpdateMeshBuffer(mesh, 0, scratchVertices.data(), VERTICES_PER_TILE * 3 * sizeof(float), firstVertex * 3 * sizeof(float));
+    UpdateMeshBuffer(mesh, RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, scratchColors.data(), VERTICES_PER_TILE * 4, firstVertex * 4);
+}
+
+void FarTerrain::UpdateVisibility(int ring) {
+    if (ring > FAR_DISTANCE) return;
+
+    ForEachInRing(centerX, centerZ, ring, [&](int tx, int tz) {
+        Tile* tile = GetTile(tx, tz);
+        if (!tile) return;
+
+        bool hidden = ring <= innerDistance;
+        if (tile->hidden != hidden) {
+            tile->hidden = hidden;
+            UploadTile(tx, tz);
+        }
+    });
+}
+
+FarTerrain::Tile* FarTerrain::GetTile(int tileX, int tileZ) {
+    Tile& tile = tiles[GetSlot(tileX, tileZ)];
+    return (tile.valid && tile.x == tileX && tile.z == tileZ) ? &tile : nullptr;
+}
+
+const FarTerrain::Tile* FarTerrain::GetTile(int tileX, int tileZ) const {
+    const Tile& tile = tiles[GetSlot(tileX, tileZ)];
+    return (tile.valid && tile.x == tileX && tile.z == tileZ) ? &tile : nullptr;
+}
+
+int FarTerrain::GetSlot(int tileX, int tileZ) const {
+    int slotX = ((tileX % WINDOW_SIZE) + WINDOW_SIZE) % WINDOW_SIZE;
+    int slotZ = ((tileZ % WINDOW_SIZE) + WINDOW_SIZE) % WINDOW_SIZE;
+    return slotZ * WINDOW_SIZE + slotX;
+}
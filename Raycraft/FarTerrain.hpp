@@ -0,0 +1,73 @@
+#ifndef FAR_TERRAIN_HPP
+#define FAR_TERRAIN_HPP
+
+#include "raylib.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class OptimizedWorld;
+struct Chunk;
+
+// Low-poly heightmap impostor for the terrain beyond the voxel render distance.
+// Every chunk column is reduced to a TILE_CELLS x TILE_CELLS grid of surface heights
+// and block types. All tiles share one dynamic mesh with a fixed vertex range per
+// ring-buffer slot, so changing a tile is a single sub-buffer upload.
+class FarTerrain {
+public:
+    static const int FAR_DISTANCE = 32;   // in chunks
+    static const int TILE_CELLS = 4;      // grid quads per chunk side
+
+private:
+    static const int WINDOW_SIZE = 2 * FAR_DISTANCE + 1;
+    static const int VERTICES_PER_TILE = TILE_CELLS * TILE_CELLS * 6;
+
+    struct Tile {
+        int x, z;
+        bool valid;
+        bool hidden;  // Inside the voxel render distance
+        uint64_t refinedVersion;  // Chunk version the surface was read from, 0 for a generator estimate
+        unsigned char heights[TILE_CELLS * TILE_CELLS];
+        unsigned char types[TILE_CELLS * TILE_CELLS];
+    };
+
+    // Ring buffer of tiles, slot = (z mod WINDOW_SIZE, x mod WINDOW_SIZE)
+    std::vector<Tile> tiles;
+    int centerX, centerZ;
+    int innerDistance;
+    bool loaded;
+
+    Mesh mesh;
+    bool meshLoaded;
+
+    // Staging buffers for a single tile upload
+    std::vector<float> scratchVertices;
+    std::vector<unsigned char> scratchColors;
+
+public:
+    FarTerrain();
+    ~FarTerrain();
+
+    // Slides the ring to the player chunk and hides tiles within innerDistance
+    void Update(const OptimizedWorld& world, int newCenterX, int newCenterZ, int newInnerDistance);
+
+    // Replaces the generator estimate of a tile with the real surface of a chunk
+    void RefineTile(const Chunk& chunk);
+
+    void Draw(const Material& material) const;
+    void Unload();
+
+    int GetVisibleTileCount() const;
+    size_t GetTileMemory() const { return tiles.size() * sizeof(Tile); }
+
+private:
+    void FillTile(const OptimizedWorld& world, int tileX, int tileZ);
+    void UploadTile(int tileX, int tileZ);
+    void UpdateVisibility(int ring);
+
+    Tile* GetTile(int tileX, int tileZ);
+    const Tile* GetTile(int tileX, int tileZ) const;
+    int GetSlot(int tileX, int tileZ) const;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "MappedFile.hpp"
+
+// Kept apart from raylib.h, whose names clash with the Windows headers
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : data(nullptr), size(0)
+#ifdef _WIN32
+    , fileHandle(nullptr), mappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = (const unsigned char*)view;
+    size = (size_t)fileSize.QuadPart;
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) return false;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0) {
+        close(file);
+        return false;
+    }
+
+    // The mapping keeps the file alive, the descriptor is not needed past this point
+    void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (view == MAP_FAILED) return false;
+
+    data = (const unsigned char*)view;
+    size = (size_t)status.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::Close() {
+    if (!data) return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    munmap((void*)data, size);
+#endif
+    data = nullptr;
+    size = 0;
+}
@@ -2,20 +2,28 @@
 #include "raymath.h"
 #include "Character.hpp"
 #include "World.hpp"
+#include "RenderDistanceController.hpp"
+#include <algorithm>
 #include <iostream>
 
 int main() {
     // Window setup
     const int screenWidth = 1280;
     const int screenHeight = 720;
+    const int targetFPS = 144;
 
+    // Frame pacing is done by the render distance controller instead of SetTargetFPS
     InitWindow(screenWidth, screenHeight, "Raycraft (I know it's lame im just trying to learn math here hehe :D)");
-    SetTargetFPS(144);
     SetExitKey(KEY_NULL);
 
-    // Initialize world and player
+    // Initialize world and player, continuing the last saved world if there is one. A new
+    // world gets its save right away, so edits are written out while playing.
+    const char* saveDirectory = "saves/world";
     OptimizedWorld world(1337);
+    if (!world.Load(saveDirectory)) world.Save(saveDirectory);
     Character player(&world, { 32, 40, 32 });
+    RenderDistanceController frameBudget(1.0f / targetFPS,
+        OptimizedWorld::MIN_RENDER_DISTANCE, OptimizedWorld::MAX_RENDER_DISTANCE, 4);
 
     // Generate crosshair
     Image crosshairImg = GenImageColor(32, 32, BLANK);
@@ -31,16 +39,34 @@ int main() {
     bool showDebug = false;
     float timeOfDay = 12.0f;
 
+    // Simulation runs at a fixed tick rate, rendering interpolates between ticks
+    const float tickTime = 1.0f / 60.0f;
+    const float maxFrameTime = 0.25f;  // Drop time after long hitches instead of spiralling
+    float tickAccumulator = 0.0f;
+
     DisableCursor();
 
     while (!WindowShouldClose()) {
+        frameBudget.BeginFrame();
         float deltaTime = GetFrameTime();
 
         // Toggle debug
         if (IsKeyPressed(KEY_F3)) showDebug = !showDebug;
+        if (IsKeyPressed(KEY_F5)) world.Save(saveDirectory);
 
         // Update systems
-        player.Update();
+        player.PollInput();
+        tickAccumulator += std::min(deltaTime, maxFrameTime);
+
+        // Hold the simulation while the ground under the player is still being read
+        if (world.IsWaitingForChunk(player.GetPosition())) tickAccumulator = 0.0f;
+        while (tickAccumulator >= tickTime) {
+            player.Tick(tickTime);
+            tickAccumulator -= tickTime;
+        }
+        player.UpdateCamera(tickAccumulator / tickTime);
+
+        world.SetRenderDistance(frameBudget.GetRenderDistance());
         world.Update(player.GetPosition());
 
         // Time cycle
@@ -68,7 +94,7 @@ int main() {
 
         // 3D Scene
         BeginMode3D(player.GetCamera());
-        world.Draw();
+        world.Draw(player.GetCamera());
         EndMode3D();
 
         // 2D UI
@@ -79,23 +105,20 @@ int main() {
             WHITE);
 
         // Hotbar
-        DrawRectangle(screenWidth / 2 - 200, screenHeight - 60, 400, 50, Color{ 0, 0, 0, 180 });
-        for (int i = 0; i < 5; i++) {
-            int x = screenWidth / 2 - 200 + i * 80;
-            bool selected = (i + 1) == player.GetSelectedBlock();
-
-            Color blockColor;
-            switch (i + 1) {
-            case 1: blockColor = GREEN; break;
-            case 2: blockColor = BROWN; break;
-            case 3: blockColor = GRAY; break;
-            case 4: blockColor = Color{ 139, 69, 19, 255 }; break;
-            case 5: blockColor = Color{ 34, 139, 34, 255 }; break;
-            default: blockColor = DARKGRAY;
-            }
+        const int hotbar[] = { BLOCK_GRASS, BLOCK_DIRT, BLOCK_STONE, BLOCK_WOOD, BLOCK_LEAVES, BLOCK_SLAB };
+        const int hotbarSlots = (int)(sizeof(hotbar) / sizeof(hotbar[0]));
+        DrawRectangle(screenWidth / 2 - hotbarSlots * 40, screenHeight - 60, hotbarSlots * 80, 50, Color{ 0, 0, 0, 180 });
+        for (int i = 0; i < hotbarSlots; i++) {
+            int x = screenWidth / 2 - hotbarSlots * 40 + i * 80;
+            bool selected = hotbar[i] == player.GetSelectedBlock();
 
-            DrawRectangle(x + 10, screenHeight - 50, 60, 30, blockColor);
-            DrawRectangleLines(x + 10, screenHeight - 50, 60, 30, BLACK);
+            Color blockColor = Block((unsigned char)hotbar[i]).GetColor();
+            blockColor.a = 255;
+
+            // Slabs are drawn half height
+            int swatchHeight = hotbar[i] == BLOCK_SLAB ? 15 : 30;
+            DrawRectangle(x + 10, screenHeight - 20 - swatchHeight, 60, swatchHeight, blockColor);
+            DrawRectangleLines(x + 10, screenHeight - 20 - swatchHeight, 60, swatchHeight, BLACK);
 
             if (selected) {
                 DrawRectangleLines(x, screenHeight - 60, 80, 50, YELLOW);
@@ -108,18 +131,47 @@ int main() {
         if (showDebug) {
             Vector3 pos = player.GetPosition();
 
-            DrawRectangle(10, 10, 250, 120, Color{ 0, 0, 0, 180 });
+            const RenderStats& stats = world.GetRenderStats();
+
+            DrawRectangle(10, 10, 300, 420, Color{ 0, 0, 0, 180 });
             DrawText(TextFormat("FPS: %d", GetFPS()), 20, 20, 18, GREEN);
             DrawText(TextFormat("Pos: %.1f, %.1f, %.1f", pos.x, pos.y, pos.z), 20, 45, 18, WHITE);
             DrawText(TextFormat("Block: %d", player.GetSelectedBlock()), 20, 70, 18, SKYBLUE);
             DrawText(TextFormat("Flying: %s", player.IsFlying() ? "YES" : "NO"), 20, 95, 18,
                 player.IsFlying() ? PURPLE : WHITE);
+            DrawText(TextFormat("Chunks: %d", stats.chunksDrawn), 20, 120, 18, WHITE);
+            DrawText(TextFormat("Faces: %d opaque, %d blend", stats.opaqueFaces, stats.translucentFaces), 20, 145, 18, WHITE);
+            DrawText(TextFormat("Render distance: %d chunks", world.GetRenderDistance()), 20, 170, 18, WHITE);
+            DrawText(TextFormat("Frame: CPU %.1f / GPU %.1f ms",
+                frameBudget.GetCpuTime() * 1000.0f, frameBudget.GetGpuTime() * 1000.0f), 20, 195, 18, WHITE);
+            DrawText(TextFormat("Headroom: %.1f ms", frameBudget.GetHeadroom() * 1000.0f),
+                20, 220, 18, frameBudget.GetHeadroom() >= 0.0f ? GREEN : RED);
+            DrawText(TextFormat("LOD tris: %d / %d / %d", stats.lodTriangles[0], stats.lodTriangles[1], stats.lodTriangles[2]),
+                20, 245, 18, WHITE);
+            DrawText(TextFormat("Far ring: %d tiles, %d KB", world.GetFarTerrain().GetVisibleTileCount(),
+                (int)(world.GetFarTerrain().GetTileMemory() / 1024)), 20, 270, 18, WHITE);
+            const ChunkPool& pool = world.GetChunkPool();
+            DrawText(TextFormat("Chunk pool: %d / %d (peak %d)", pool.GetInUse(), pool.GetCapacity(),
+                pool.GetHighWaterMark()), 20, 295, 18, WHITE);
+            const ChunkIOStats io = world.GetIOStats();
+            DrawText(TextFormat("I/O queue: %d reads, %d writes", io.queuedReads, io.queuedWrites), 20, 320, 18, WHITE);
+            DrawText(TextFormat("I/O read: %.1f ms (peak %.1f)", io.readLatency, io.readLatencyPeak), 20, 345, 18, WHITE);
+            DrawText(TextFormat("I/O write: %.1f ms", io.writeLatency), 20, 370, 18, WHITE);
+            DrawText(TextFormat("Journal: %d edits", io.journalEdits), 20, 395, 18, WHITE);
         }
 
+        frameBudget.EndCpuWork();
         EndDrawing();
+        frameBudget.EndFrame();
+
+        // Sleep off what is left of the frame budget
+        WaitTime(frameBudget.GetRemainingFrameTime());
     }
 
-    // Cleanup
+    // Cleanup, waiting for the final save to reach the disk
+    world.Save(saveDirectory);
+    world.FlushIO();
+    world.UnloadRenderData();
     UnloadTexture(crosshair);
     CloseWindow();
 
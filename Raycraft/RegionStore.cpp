@@ -0,0 +1,434 @@
+#include "RegionStore.hpp"
+#include "World.hpp"
+#include "SectionCodec.hpp"
+#include "raylib.h"
+#include <cstring>
+#include <filesystem>
+
+namespace {
+    const uint32_t REGION_MAGIC = 0x47524352;  // "RCRG"
+    const uint32_t FORMAT_VERSION = 1;
+
+    struct RegionHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t chunkSize;
+        uint32_t worldHeight;
+        uint32_t tableCrc;
+    };
+
+    // Record encodings
+    const uint32_t ENCODING_RAW = 0;
+    const uint32_t ENCODING_RUNS = 1;
+    const uint32_t ENCODING_MAPPED_UNCHECKED = 2;  // Older mappable records, only ever copied
+    const uint32_t ENCODING_SECTIONS = 3;
+    const uint32_t ENCODING_MAPPED = 4;
+
+    // Mappable records start on a cache line, like the pool's block buffers
+    const uint32_t MAPPED_ALIGNMENT = 64;
+    // Their tail: brick occupancy, the flags byte and, in checked records, the CRC32 of
+    // those two
+    const int OCCUPANCY_BYTES = SECTION_COUNT * sizeof(uint64_t);
+    const int MAPPED_TAIL_BYTES = OCCUPANCY_BYTES + 1 + sizeof(uint32_t);
+    const int UNCHECKED_TAIL_BYTES = OCCUPANCY_BYTES + 1;
+
+    // Record flags byte
+    const unsigned char RECORD_MODIFIED = 1 << 0;
+    const unsigned char RECORD_STATES = 1 << 1;
+
+    const int RECORD_MAX_BYTES = CHUNK_VOLUME + Chunk::STATE_BYTES + MAPPED_TAIL_BYTES;
+
+    // (run length - 1, value) byte pairs over the whole record, as written before records
+    // were encoded per section. Returns the decoded size, or -1 if the runs overflow the output.
+    int DecodeRuns(const unsigned char* data, int size, unsigned char* output, int capacity) {
+        if (size % 2 != 0) return -1;
+        int written = 0;
+        for (int i = 0; i < size; i += 2) {
+            const int run = data[i] + 1;
+            if (written + run > capacity) return -1;
+            memset(output + written, data[i + 1], run);
+            written += run;
+        }
+        return written;
+    }
+
+    unsigned char GetNibble(const unsigned char* nibbles, int index) {
+        return (nibbles[index >> 1] >> ((index & 1) * BLOCK_STATE_BITS)) & BLOCK_STATE_MASK;
+    }
+
+    void SetNibble(unsigned char* nibbles, int index, unsigned char value) {
+        const int shift = (index & 1) * BLOCK_STATE_BITS;
+        nibbles[index >> 1] = (unsigned char)((nibbles[index >> 1] & ~(BLOCK_STATE_MASK << shift)) | (value << shift));
+    }
+
+    // Records always store y-z-x order, whatever layout the chunk uses in memory
+    // Returns the decoded record size, or -1 if the sections are malformed
+    int DecodeSections(const unsigned char* data, int size, unsigned char* record) {
+        if (size < 1) return -1;
+        record[0] = data[0];
+        const bool hasStates = (data[0] & RECORD_STATES) != 0;
+
+        int offset = 1;
+        for (int section = 0; section < SECTION_COUNT; section++) {
+            const int read = SectionCodec::Decode(data + offset, size - offset, record + 1 + section * SECTION_VOLUME, SECTION_VOLUME);
+            if (read < 0) return -1;
+            offset += read;
+        }
+        if (hasStates) {
+            unsigned char* states = record + 1 + CHUNK_VOLUME;
+            for (int section = 0; section < SECTION_COUNT; section++) {
+                const int read = SectionCodec::Decode(data + offset, size - offset, states + section * SECTION_VOLUME / 2, SECTION_VOLUME / 2);
+                if (read < 0) return -1;
+                offset += read;
+            }
+        }
+        if (offset != size) return -1;
+        return 1 + CHUNK_VOLUME + (hasStates ? Chunk::STATE_BYTES : 0);
+    }
+
+    int RecordIndex(int x, int y, int z) {
+        return (y * CHUNK_SIZE + z) * CHUNK_SIZE + x;
+    }
+
+    int FloorDiv(int value, int divisor) {
+        return (value >= 0 ? value : value - (divisor - 1)) / divisor;
+    }
+}
+
+RegionStore::RegionStore(const std::string& saveDirectory, RegionFormat writeFormat, bool mapRecords)
+    : directory(saveDirectory), format(writeFormat), mapReads(mapRecords) {
+    encoded.reserve(RECORD_MAX_BYTES * 2);
+    raw.resize(RECORD_MAX_BYTES);
+}
+
+bool RegionStore::ReadChunk(Chunk& chunk, bool allowMapping) {
+    const int regionX = FloorDiv(chunk.x, REGION_SIZE);
+    const int regionZ = FloorDiv(chunk.z, REGION_SIZE);
+    Region* region = GetRegion(regionX, regionZ);
+
+    const int slot = (chunk.z - regionZ * REGION_SIZE) * REGION_SIZE + (chunk.x - regionX * REGION_SIZE);
+    const Entry& entry = region->table[slot];
+    if (entry.offset == 0 || !region->file.is_open()) return false;
+
+    // Mapped records are always in row order, brick-layout builds copy them instead. One
+    // that cannot be mapped is read like any other, checking the whole record.
+    if (entry.encoding == ENCODING_MAPPED && allowMapping && mapReads && ChunkDims::ROWS_CONTIGUOUS
+        && MapChunk(*region, entry, chunk)) {
+        return true;
+    }
+
+    encoded.resize(entry.size);
+    region->file.clear();
+    region->file.seekg(entry.offset);
+    if (!region->file.read((char*)encoded.data(), entry.size)) {
+        TraceLog(LOG_WARNING, "REGION: Chunk [%d, %d] could not be read", chunk.x, chunk.z);
+        return false;
+    }
+    if (ComputeCRC32(encoded.data(), (int)entry.size) != entry.crc) {
+        TraceLog(LOG_WARNING, "REGION: Chunk [%d, %d] failed its checksum", chunk.x, chunk.z);
+        return false;
+    }
+    return DecodeChunk(entry, chunk);
+}
+
+bool RegionStore::WriteChunks(const std::vector<const Chunk*>& chunks) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // Chunks to store, grouped by region file
+    std::unordered_map<long long, std::vector<const Chunk*>> byRegion;
+    for (const Chunk* chunk : chunks) {
+        const int regionX = FloorDiv(chunk->x, REGION_SIZE);
+        const int regionZ = FloorDiv(chunk->z, REGION_SIZE);
+        byRegion[((long long)regionX << 32) | (unsigned int)regionZ].push_back(chunk);
+    }
+
+    bool success = true;
+    std::vector<unsigned char> payload;
+    std::vector<unsigned char> record;
+
+    for (auto& [key, regionChunks] : byRegion) {
+        const int regionX = (int)(key >> 32);
+        const int regionZ = (int)(unsigned int)key;
+        Region* region = GetRegion(regionX, regionZ);
+
+        std::array<const Chunk*, REGION_CHUNKS> replacements{};
+        for (const Chunk* chunk : regionChunks) {
+            replacements[(chunk->z - regionZ * REGION_SIZE) * REGION_SIZE + (chunk->x - regionX * REGION_SIZE)] = chunk;
+        }
+
+        // New chunks are encoded, the rest of the old file is carried over byte for byte
+        region->mapping.Close();
+        std::array<Entry, REGION_CHUNKS> table{};
+        const uint32_t payloadStart = (uint32_t)(sizeof(RegionHeader) + sizeof(table));
+        payload.clear();
+
+        for (int slot = 0; slot < REGION_CHUNKS; slot++) {
+            Entry& entry = table[slot];
+            if (replacements[slot]) {
+                EncodeChunk(*replacements[slot], record, entry);
+            }
+            else if (region->table[slot].offset != 0 && region->file.is_open()) {
+                entry = region->table[slot];
+                record.resize(entry.size);
+                region->file.clear();
+                region->file.seekg(entry.offset);
+                if (!region->file.read((char*)record.data(), entry.size)) {
+                    TraceLog(LOG_WARNING, "REGION: Dropping unreadable chunk %d of region [%d, %d]", slot, regionX, regionZ);
+                    entry = {};
+                    continue;
+                }
+            }
+            else {
+                continue;
+            }
+
+            if (entry.encoding == ENCODING_MAPPED) {
+                const uint32_t misalignment = (payloadStart + (uint32_t)payload.size()) % MAPPED_ALIGNMENT;
+                if (misalignment != 0) payload.resize(payload.size() + MAPPED_ALIGNMENT - misalignment, 0);
+            }
+            entry.offset = payloadStart + (uint32_t)payload.size();
+            payload.insert(payload.end(), record.begin(), record.end());
+        }
+
+        RegionHeader header = { REGION_MAGIC, FORMAT_VERSION, CHUNK_SIZE, WORLD_HEIGHT, 0 };
+        header.tableCrc = ComputeCRC32((unsigned char*)table.data(), (int)sizeof(table));
+
+        // Write beside the old file and swap it in, so a failed save leaves the old one intact
+        const std::string path = GetRegionPath(regionX, regionZ);
+        const std::string temporaryPath = path + ".tmp";
+        region->file.close();
+        {
+            std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+            output.write((const char*)&header, sizeof(header));
+            output.write((const char*)table.data(), sizeof(table));
+            output.write((const char*)payload.data(), (std::streamsize)payload.size());
+            if (!output) {
+                TraceLog(LOG_WARNING, "REGION: Failed to write %s", temporaryPath.c_str());
+                success = false;
+                region->file.open(path, std::ios::binary);
+                continue;
+            }
+        }
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error) {
+            TraceLog(LOG_WARNING, "REGION: Failed to replace %s", path.c_str());
+            success = false;
+            region->file.open(path, std::ios::binary);
+            continue;
+        }
+
+        region->table = table;
+        region->file.open(path, std::ios::binary);
+    }
+
+    return success;
+}
+
+long long RegionStore::GetRegionKey(int chunkX, int chunkZ) {
+    return ((long long)FloorDiv(chunkX, REGION_SIZE) << 32) | (unsigned int)FloorDiv(chunkZ, REGION_SIZE);
+}
+
+RegionStore::Region* RegionStore::GetRegion(int regionX, int regionZ) {
+    std::unique_ptr<Region>& region = regions[((long long)regionX << 32) | (unsigned int)regionZ];
+    if (region) return region.get();
+
+    region = std::make_unique<Region>();
+    region->table = {};
+
+    const std::string path = GetRegionPath(regionX, regionZ);
+    region->file.open(path, std::ios::binary);
+    if (!region->file.is_open()) return region.get();
+
+    // A region that does not match this build is treated as empty
+    RegionHeader header = {};
+    std::array<Entry, REGION_CHUNKS> table;
+    region->file.read((char*)&header, sizeof(header));
+    region->file.read((char*)table.data(), sizeof(table));
+    if (!region->file || header.magic != REGION_MAGIC || header.version != FORMAT_VERSION) {
+        TraceLog(LOG_WARNING, "REGION: %s is not a region file of this version", path.c_str());
+    }
+    else if (header.chunkSize != CHUNK_SIZE || header.worldHeight != WORLD_HEIGHT) {
+        TraceLog(LOG_WARNING, "REGION: %s was saved with %dx%d chunks", path.c_str(), header.chunkSize, header.worldHeight);
+    }
+    else if (ComputeCRC32((unsigned char*)table.data(), (int)sizeof(table)) != header.tableCrc) {
+        TraceLog(LOG_WARNING, "REGION: %s has a damaged chunk table", path.c_str());
+    }
+    else {
+        region->table = table;
+    }
+    return region.get();
+}
+
+std::string RegionStore::GetRegionPath(int regionX, int regionZ) const {
+    return (std::filesystem::path(directory) / ("r." + std::to_string(regionX) + "." + std::to_string(regionZ) + ".rcr")).string();
+}
+
+void RegionStore::EncodeChunk(const Chunk& chunk, std::vector<unsigned char>& output, Entry& entry) {
+    const unsigned char flags = (chunk.modified ? RECORD_MODIFIED : 0) | (chunk.HasStates() ? RECORD_STATES : 0);
+
+    if (format == REGION_MAPPABLE && ChunkDims::ROWS_CONTIGUOUS) {
+        const int statesSize = chunk.HasStates() ? Chunk::STATE_BYTES : 0;
+        output.resize(CHUNK_VOLUME + statesSize + MAPPED_TAIL_BYTES);
+        unsigned char* record = output.data();
+        memcpy(record, chunk.blocks, CHUNK_VOLUME);
+        if (statesSize) memcpy(record + CHUNK_VOLUME, chunk.states.get(), statesSize);
+        memcpy(record + CHUNK_VOLUME + statesSize, chunk.brickOccupancy.data(), OCCUPANCY_BYTES);
+        record[CHUNK_VOLUME + statesSize + OCCUPANCY_BYTES] = flags;
+        const uint32_t tailCrc = ComputeCRC32(record + CHUNK_VOLUME + statesSize, OCCUPANCY_BYTES + 1);
+        memcpy(record + output.size() - sizeof(tailCrc), &tailCrc, sizeof(tailCrc));
+
+        entry.encoding = ENCODING_MAPPED;
+        entry.size = (uint32_t)output.size();
+        entry.crc = ComputeCRC32(output.data(), (int)output.size());
+        return;
+    }
+
+    unsigned char* record = raw.data();
+    record[0] = flags;
+    unsigned char* blocks = record + 1;
+    unsigned char* states = blocks + CHUNK_VOLUME;
+
+    if constexpr (ChunkDims::ROWS_CONTIGUOUS) {
+        memcpy(blocks, chunk.blocks, CHUNK_VOLUME);
+        if (chunk.HasStates()) memcpy(states, chunk.states.get(), Chunk::STATE_BYTES);
+    }
+    else {
+        for (int y = 0; y < WORLD_HEIGHT; y++) {
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                for (int x = 0; x < CHUNK_SIZE; x++) {
+                    const int index = ChunkDims::Index(x, y, z);
+                    blocks[RecordIndex(x, y, z)] = chunk.blocks[index].type;
+                    if (chunk.HasStates()) SetNibble(states, RecordIndex(x, y, z), GetNibble(chunk.states.get(), index));
+                }
+            }
+        }
+    }
+
+    // The flags byte, then every block section and, if present, every state section.
+    // Fall back to the plain bytes when that does not pay off.
+    const int size = 1 + CHUNK_VOLUME + (chunk.HasStates() ? Chunk::STATE_BYTES : 0);
+    output.assign(1, flags);
+    for (int section = 0; section < SECTION_COUNT; section++) {
+        SectionCodec::Encode(blocks + section * SECTION_VOLUME, SECTION_VOLUME, output);
+    }
+    if (chunk.HasStates()) {
+        for (int section = 0; section < SECTION_COUNT; section++) {
+            SectionCodec::Encode(states + section * SECTION_VOLUME / 2, SECTION_VOLUME / 2, output);
+        }
+    }
+    entry.encoding = ENCODING_SECTIONS;
+    if ((int)output.size() >= size) {
+        output.assign(record, record + size);
+        entry.encoding = ENCODING_RAW;
+    }
+    entry.size = (uint32_t)output.size();
+    entry.crc = ComputeCRC32(output.data(), (int)output.size());
+}
+
+bool RegionStore::DecodeChunk(const Entry& entry, Chunk& chunk) {
+    // Mapped records are already plain bytes; reorder them into a regular record. Their
+    // stored occupancy is dropped and recomputed like for every other record.
+    if (entry.encoding == ENCODING_MAPPED || entry.encoding == ENCODING_MAPPED_UNCHECKED) {
+        const int size = (int)encoded.size();
+        const int tailBytes = entry.encoding == ENCODING_MAPPED ? MAPPED_TAIL_BYTES : UNCHECKED_TAIL_BYTES;
+        const int flagsOffset = size - tailBytes + OCCUPANCY_BYTES;
+        const bool hasStates = flagsOffset >= 0 && (encoded[flagsOffset] & RECORD_STATES);
+        if (size != CHUNK_VOLUME + (hasStates ? Chunk::STATE_BYTES : 0) + tailBytes) {
+            TraceLog(LOG_WARNING, "REGION: Chunk [%d, %d] has a malformed record", chunk.x, chunk.z);
+            return false;
+        }
+        raw[0] = encoded[flagsOffset];
+        memcpy(raw.data() + 1, encoded.data(), CHUNK_VOLUME + (hasStates ? Chunk::STATE_BYTES : 0));
+        encoded.resize(1 + CHUNK_VOLUME + (hasStates ? Chunk::STATE_BYTES : 0));
+        memcpy(encoded.data(), raw.data(), encoded.size());
+        return DecodeChunk({ entry.offset, (uint32_t)encoded.size(), 0, ENCODING_RAW }, chunk);
+    }
+
+    int size = -1;
+    if (entry.encoding == ENCODING_SECTIONS) {
+        size = DecodeSections(encoded.data(), (int)encoded.size(), raw.data());
+    }
+    else if (entry.encoding == ENCODING_RUNS) {
+        size = DecodeRuns(encoded.data(), (int)encoded.size(), raw.data(), RECORD_MAX_BYTES);
+    }
+    else if (entry.encoding == ENCODING_RAW && encoded.size() <= raw.size()) {
+        memcpy(raw.data(), encoded.data(), encoded.size());
+        size = (int)encoded.size();
+    }
+
+    const unsigned char* record = raw.data();
+    const bool hasStates = size > 0 && (record[0] & RECORD_STATES);
+    if (size != 1 + CHUNK_VOLUME + (hasStates ? Chunk::STATE_BYTES : 0)) {
+        TraceLog(LOG_WARNING, "REGION: Chunk [%d, %d] has a malformed record", chunk.x, chunk.z);
+        return false;
+    }
+
+    const unsigned char* blocks = record + 1;
+    const unsigned char* states = blocks + CHUNK_VOLUME;
+    if (hasStates) chunk.states = std::make_unique<unsigned char[]>(Chunk::STATE_BYTES);
+
+    if constexpr (ChunkDims::ROWS_CONTIGUOUS) {
+        memcpy(chunk.storage, blocks, CHUNK_VOLUME);
+        if (hasStates) memcpy(chunk.states.get(), states, Chunk::STATE_BYTES);
+    }
+    else {
+        for (int y = 0; y < WORLD_HEIGHT; y++) {
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                for (int x = 0; x < CHUNK_SIZE; x++) {
+                    const int index = ChunkDims::Index(x, y, z);
+                    chunk.storage[index] = Block(blocks[RecordIndex(x, y, z)]);
+                    if (hasStates) SetNibble(chunk.states.get(), index, GetNibble(states, RecordIndex(x, y, z)));
+                }
+            }
+        }
+    }
+
+    chunk.modified = (record[0] & RECORD_MODIFIED) != 0;
+    chunk.RecomputeOccupancy();
+    chunk.version++;
+    chunk.dirty = true;
+    return true;
+}
+
+bool RegionStore::MapChunk(Region& region, const Entry& entry, Chunk& chunk) {
+    if (!region.mapping.IsOpen() && !region.mapping.Open(GetRegionPath(FloorDiv(chunk.x, REGION_SIZE), FloorDiv(chunk.z, REGION_SIZE)))) {
+        return false;
+    }
+    if ((uint64_t)entry.offset + entry.size > region.mapping.GetSize() || entry.offset % MAPPED_ALIGNMENT != 0) {
+        TraceLog(LOG_WARNING, "REGION: Chunk [%d, %d] lies outside its region file", chunk.x, chunk.z);
+        return false;
+    }
+
+    if (entry.size < (uint32_t)MAPPED_TAIL_BYTES) {
+        TraceLog(LOG_WARNING, "REGION: Chunk [%d, %d] has a malformed record", chunk.x, chunk.z);
+        return false;
+    }
+
+    // Only the tail is read here; block pages are faulted in when something looks at them.
+    // The tail has its own checksum, as a damaged occupancy bit would hide solid bricks.
+    const unsigned char* record = region.mapping.GetData() + entry.offset;
+    const unsigned char flags = record[entry.size - MAPPED_TAIL_BYTES + OCCUPANCY_BYTES];
+    const int statesSize = (flags & RECORD_STATES) ? Chunk::STATE_BYTES : 0;
+    if ((int)entry.size != CHUNK_VOLUME + statesSize + MAPPED_TAIL_BYTES) {
+        TraceLog(LOG_WARNING, "REGION: Chunk [%d, %d] has a malformed record", chunk.x, chunk.z);
+        return false;
+    }
+    uint32_t tailCrc;
+    memcpy(&tailCrc, record + entry.size - sizeof(tailCrc), sizeof(tailCrc));
+    if (ComputeCRC32((unsigned char*)record + CHUNK_VOLUME + statesSize, OCCUPANCY_BYTES + 1) != tailCrc) {
+        TraceLog(LOG_WARNING, "REGION: Chunk [%d, %d] failed its tail checksum", chunk.x, chunk.z);
+        return false;
+    }
+
+    chunk.MapBlocks((const Block*)record);
+    if (statesSize) {
+        chunk.states = std::make_unique<unsigned char[]>(Chunk::STATE_BYTES);
+        memcpy(chunk.states.get(), record + CHUNK_VOLUME, Chunk::STATE_BYTES);
+    }
+    memcpy(chunk.brickOccupancy.data(), record + CHUNK_VOLUME + statesSize, OCCUPANCY_BYTES);
+    chunk.modified = (flags & RECORD_MODIFIED) != 0;
+    chunk.version++;
+    chunk.dirty = true;
+    return true;
+}
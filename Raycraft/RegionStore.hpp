@@ -0,0 +1,98 @@
+#ifndef REGION_STORE_HPP
+#define REGION_STORE_HPP
+
+#include "MappedFile.hpp"
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Chunk;
+
+// How chunk records are written: compressed section by section, or raw and cache-line
+// aligned so a reader can point chunks straight into a memory mapping of the region file
+enum RegionFormat {
+    REGION_COMPRESSED = 0,
+    REGION_MAPPABLE
+};
+
+// Chunk storage on disk, REGION_SIZE x REGION_SIZE chunks per region file:
+//   header   magic, format version, chunk geometry, CRC32 of the table
+//   table    one Entry per chunk slot, slot = localZ * REGION_SIZE + localX
+//   payload  each stored chunk as one record
+// A record decodes to a flags byte, the blocks in y-z-x order and, if flagged, the
+// block state nibbles in the same order. After the flags byte, each section of blocks
+// and then of states is stored by SectionCodec; records of older saves are run-length
+// encoded as a whole. Every record carries the CRC32 of its encoded bytes so a damaged
+// chunk is regenerated instead of loaded.
+// Mappable records instead hold the blocks in memory order at a 64-byte aligned offset,
+// then the states, the brick occupancy, the flags byte and a CRC32 of the occupancy and
+// flags, so nothing has to be decoded. Mapping verifies only that CRC, since a damaged
+// occupancy bit would hide solid bricks from raycasts and meshing; a record that fails
+// it is read and checked as a whole instead. Blocks and states are only verified when
+// copied: a damaged byte there can only turn into a wrong block type or state, and
+// every type byte is a valid table index.
+class RegionStore {
+public:
+    static const int REGION_SIZE = 32;
+    static const int REGION_CHUNKS = REGION_SIZE * REGION_SIZE;
+
+private:
+    struct Entry {
+        uint32_t offset;   // From the start of the file, 0 if the slot is empty
+        uint32_t size;     // Encoded bytes
+        uint32_t crc;      // CRC32 of the encoded bytes
+        uint32_t encoding; // How the record is stored
+    };
+
+    struct Region {
+        std::array<Entry, REGION_CHUNKS> table;
+        std::ifstream file;
+        MappedFile mapping;  // Opened on the first mapped read
+    };
+
+    std::string directory;
+    RegionFormat format;
+    bool mapReads;
+    std::unordered_map<long long, std::unique_ptr<Region>> regions;
+
+    // Reused between records so loading does not allocate per chunk
+    std::vector<unsigned char> encoded;
+    std::vector<unsigned char> raw;
+
+public:
+    explicit RegionStore(const std::string& saveDirectory, RegionFormat writeFormat = REGION_COMPRESSED,
+        bool mapRecords = true);
+
+    RegionStore(const RegionStore&) = delete;
+    RegionStore& operator=(const RegionStore&) = delete;
+
+    // Fills a freshly acquired chunk (x and z already set) from disk; false if the chunk
+    // was never saved or its record is damaged. With allowMapping, mappable records are
+    // referenced in place and the chunk copies them into its buffer on its first edit.
+    bool ReadChunk(Chunk& chunk, bool allowMapping = true);
+
+    // Stores the chunks, rewriting each region file they touch. Other chunks already
+    // in those files are kept. Files are replaced atomically; no loaded chunk may still
+    // be mapped from a file that is rewritten.
+    bool WriteChunks(const std::vector<const Chunk*>& chunks);
+
+    const std::string& GetDirectory() const { return directory; }
+    void SetFormat(RegionFormat writeFormat) { format = writeFormat; }
+
+    // Identifies the region file a chunk is stored in
+    static long long GetRegionKey(int chunkX, int chunkZ);
+
+private:
+    Region* GetRegion(int regionX, int regionZ);
+    std::string GetRegionPath(int regionX, int regionZ) const;
+
+    void EncodeChunk(const Chunk& chunk, std::vector<unsigned char>& output, Entry& entry);
+    bool DecodeChunk(const Entry& entry, Chunk& chunk);
+    bool MapChunk(Region& region, const Entry& entry, Chunk& chunk);
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "RenderDistanceController.hpp"
+#include <algorithm>
+
+RenderDistanceController::RenderDistanceController(float targetFrameTime, int minDistance, int maxDistance, int startDistance)
+    : targetFrameTime(targetFrameTime),
+    minDistance(minDistance),
+    maxDistance(maxDistance),
+    renderDistance(std::clamp(startDistance, minDistance, maxDistance)),
+    cpuSum(0.0f),
+    gpuSum(0.0f),
+    sampleIndex(0),
+    sampleCount(0),
+    cooldown(0),
+    frameStart(0.0),
+    cpuEnd(0.0) {
+    cpuSamples.fill(0.0f);
+    gpuSamples.fill(0.0f);
+}
+
+void RenderDistanceController::BeginFrame() {
+    frameStart = GetTime();
+}
+
+void RenderDistanceController::EndCpuWork() {
+    cpuEnd = GetTime();
+}
+
+void RenderDistanceController::EndFrame() {
+    double now = GetTime();
+    float cpuTime = (float)(cpuEnd - frameStart);
+    float gpuTime = (float)(now - cpuEnd);
+
+    // Replace the oldest sample in the rolling window
+    cpuSum += cpuTime - cpuSamples[sampleIndex];
+    gpuSum += gpuTime - gpuSamples[sampleIndex];
+    cpuSamples[sampleIndex] = cpuTime;
+    gpuSamples[sampleIndex] = gpuTime;
+    sampleIndex = (sampleIndex + 1) % SAMPLE_COUNT;
+    if (sampleCount < SAMPLE_COUNT) sampleCount++;
+
+    Adjust();
+}
+
+float RenderDistanceController::GetRemainingFrameTime() const {
+    return std::max(0.0f, targetFrameTime - (float)(GetTime() - frameStart));
+}
+
+void RenderDistanceController::Adjust() {
+    if (cooldown > 0) {
+        cooldown--;
+        return;
+    }
+    if (sampleCount < SAMPLE_COUNT) return;
+
+    // Outside the hysteresis band only; anything in between keeps the current distance
+    float frameWork = GetCpuTime() + GetGpuTime();
+    if (frameWork > targetFrameTime * SHRINK_THRESHOLD && renderDistance > minDistance) {
+        renderDistance--;
+        cooldown = SAMPLE_COUNT;
+    }
+    else if (frameWork < targetFrameTime * GROW_THRESHOLD && renderDistance < maxDistance) {
+        renderDistance++;
+        cooldown = SAMPLE_COUNT;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef RENDER_DISTANCE_CONTROLLER_HPP
+#define RENDER_DISTANCE_CONTROLLER_HPP
+
+#include "raylib.h"
+#include <array>
+
+// Grows or shrinks the chunk render distance to hold a target frame time.
+// CPU time is measured from the start of the frame until the draw calls are
+// submitted; GPU time is the time spent blocked in the buffer swap.
+class RenderDistanceController {
+private:
+    static const int SAMPLE_COUNT = 60;       // Rolling window length in frames
+    static constexpr float GROW_THRESHOLD = 0.6f;     // Grow below 60% of the budget
+    static constexpr float SHRINK_THRESHOLD = 0.95f;  // Shrink above 95% of the budget
+
+    float targetFrameTime;
+    int minDistance;
+    int maxDistance;
+    int renderDistance;
+
+    // Rolling samples
+    std::array<float, SAMPLE_COUNT> cpuSamples;
+    std::array<float, SAMPLE_COUNT> gpuSamples;
+    float cpuSum;
+    float gpuSum;
+    int sampleIndex;
+    int sampleCount;
+
+    // Frames to wait after a change so the whole window holds samples at the new distance
+    int cooldown;
+
+    double frameStart;
+    double cpuEnd;
+
+public:
+    RenderDistanceController(float targetFrameTime, int minDistance, int maxDistance, int startDistance);
+
+    void BeginFrame();
+    void EndCpuWork();
+    void EndFrame();
+
+    // Remaining time to sleep so the frame lasts the target frame time
+    float GetRemainingFrameTime() const;
+
+    int GetRenderDistance() const { return renderDistance; }
+    float GetTargetFrameTime() const { return targetFrameTime; }
+    float GetCpuTime() const { return sampleCount > 0 ? cpuSum / sampleCount : 0.0f; }
+    float GetGpuTime() const { return sampleCount > 0 ? gpuSum / sampleCount : 0.0f; }
+    float GetHeadroom() const { return targetFrameTime - GetCpuTime() - GetGpuTime(); }
+
+private:
+    void Adjust();
+};
+
+#endif
@@ -0,0 +1,288 @@
+#include "SectionCodec.hpp"
+#include <climits>
+#include <cstring>
+
+// Packed sections are unpacked 16 bytes at a time with SSSE3 byte shuffles when the CPU
+// has them; building with RAYCRAFT_SECTION_SIMD=0 keeps only the scalar loop
+#ifndef RAYCRAFT_SECTION_SIMD
+#define RAYCRAFT_SECTION_SIMD 1
+#endif
+#if RAYCRAFT_SECTION_SIMD && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define SECTION_CODEC_SSSE3 1
+#include <tmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SSSE3_FUNCTION
+#else
+#define SSSE3_FUNCTION __attribute__((target("ssse3")))
+#endif
+#endif
+
+namespace {
+    enum SectionMode : unsigned char {
+        MODE_UNIFORM,
+        MODE_RUNS,
+        MODE_PACKED,
+        MODE_RAW
+    };
+
+    // Palettes up to this size use one-byte run tokens and can be packed
+    const int SMALL_PALETTE = 16;
+    // Longest run of a one-byte token; the length nibble 15 means a varint length follows
+    const int SHORT_RUN = 15;
+
+    int GetIndexBits(int paletteSize) {
+        return paletteSize <= 2 ? 1 : (paletteSize <= 4 ? 2 : 4);
+    }
+
+    void PutVarint(std::vector<unsigned char>& output, unsigned int value) {
+        while (value >= 0x80) {
+            output.push_back((unsigned char)(value | 0x80));
+            value >>= 7;
+        }
+        output.push_back((unsigned char)value);
+    }
+
+    int GetVarintSize(unsigned int value) {
+        int size = 1;
+        while (value >= 0x80) {
+            value >>= 7;
+            size++;
+        }
+        return size;
+    }
+
+    // Returns the bytes read, 0 if the varint is cut off or too long
+    int GetVarint(const unsigned char* data, int size, unsigned int& value) {
+        value = 0;
+        for (int i = 0; i < size && i < 5; i++) {
+            value |= (unsigned int)(data[i] & 0x7F) << (7 * i);
+            if (!(data[i] & 0x80)) return i + 1;
+        }
+        return 0;
+    }
+
+#ifdef SECTION_CODEC_SSSE3
+    bool HasSsse3() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) != 0;
+#else
+        return __builtin_cpu_supports("ssse3");
+#endif
+    }
+
+    const bool useSsse3 = HasSsse3();
+
+    // Unpacks whole 16-byte blocks and returns how many indices that covered. Indices
+    // are spread to one per byte and looked up in the palette with a single shuffle.
+    SSSE3_FUNCTION int UnpackSsse3(const unsigned char* packed, int bits, const unsigned char* table,
+        unsigned char* output, int count) {
+        const __m128i palette = _mm_loadu_si128((const __m128i*)table);
+        const int blockIndices = 16 * 8 / bits;
+        int done = 0;
+
+        for (; done + blockIndices <= count; done += blockIndices, packed += 16) {
+            const __m128i bytes = _mm_loadu_si128((const __m128i*)packed);
+            __m128i* out = (__m128i*)(output + done);
+
+            if (bits == 4) {
+                const __m128i mask = _mm_set1_epi8(0x0F);
+                const __m128i low = _mm_and_si128(bytes, mask);
+                const __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+                _mm_storeu_si128(out, _mm_shuffle_epi8(palette, _mm_unpacklo_epi8(low, high)));
+                _mm_storeu_si128(out + 1, _mm_shuffle_epi8(palette, _mm_unpackhi_epi8(low, high)));
+            }
+            else if (bits == 2) {
+                const __m128i mask = _mm_set1_epi8(0x03);
+                const __m128i i0 = _mm_and_si128(bytes, mask);
+                const __m128i i1 = _mm_and_si128(_mm_srli_epi16(bytes, 2), mask);
+                const __m128i i2 = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+                const __m128i i3 = _mm_and_si128(_mm_srli_epi16(bytes, 6), mask);
+                const __m128i low01 = _mm_unpacklo_epi8(i0, i1);
+                const __m128i high01 = _mm_unpackhi_epi8(i0, i1);
+                const __m128i low23 = _mm_unpacklo_epi8(i2, i3);
+                const __m128i high23 = _mm_unpackhi_epi8(i2, i3);
+                _mm_storeu_si128(out, _mm_shuffle_epi8(palette, _mm_unpacklo_epi16(low01, low23)));
+                _mm_storeu_si128(out + 1, _mm_shuffle_epi8(palette, _mm_unpackhi_epi16(low01, low23)));
+                _mm_storeu_si128(out + 2, _mm_shuffle_epi8(palette, _mm_unpacklo_epi16(high01, high23)));
+                _mm_storeu_si128(out + 3, _mm_shuffle_epi8(palette, _mm_unpackhi_epi16(high01, high23)));
+            }
+            else {
+                // Each pair of bytes fills 16 outputs: broadcast a byte to 8 lanes, then
+                // test one bit per lane
+                const __m128i bitMask = _mm_set1_epi64x(0x8040201008040201ll);
+                const __m128i one = _mm_set1_epi8(1);
+                __m128i select = _mm_set_epi64x(0x0101010101010101ll, 0);
+                for (int pair = 0; pair < 8; pair++) {
+                    const __m128i spread = _mm_and_si128(_mm_shuffle_epi8(bytes, select), bitMask);
+                    const __m128i indices = _mm_and_si128(_mm_cmpeq_epi8(spread, bitMask), one);
+                    _mm_storeu_si128(out + pair, _mm_shuffle_epi8(palette, indices));
+                    select = _mm_add_epi8(select, _mm_set1_epi8(2));
+                }
+            }
+        }
+        return done;
+    }
+#endif
+
+    // table holds SMALL_PALETTE entries, zero past the palette, so a damaged index reads as 0
+    void UnpackIndices(const unsigned char* packed, int bits, const unsigned char* table, unsigned char* output, int count) {
+        int done = 0;
+#ifdef SECTION_CODEC_SSSE3
+        if (useSsse3) done = UnpackSsse3(packed, bits, table, output, count);
+#endif
+        const int perByte = 8 / bits;
+        const unsigned int mask = (1u << bits) - 1;
+        for (int i = done; i < count; i += perByte) {
+            unsigned int byte = packed[i / perByte];
+            const int end = i + perByte < count ? i + perByte : count;
+            for (int j = i; j < end; j++, byte >>= bits) {
+                output[j] = table[byte & mask];
+            }
+        }
+    }
+}
+
+void SectionCodec::Encode(const unsigned char* data, int count, std::vector<unsigned char>& output) {
+    // One pass over the runs finds the palette, in order of first use, and what the runs
+    // would cost with either token form
+    bool seen[256] = {};
+    unsigned char indices[256];
+    unsigned char palette[256];
+    int paletteSize = 0;
+    int shortTokenBytes = 0;
+    int longTokenBytes = 0;
+    for (int i = 0; i < count;) {
+        const unsigned char value = data[i];
+        int run = 1;
+        while (i + run < count && data[i + run] == value) run++;
+        if (!seen[value]) {
+            seen[value] = true;
+            indices[value] = (unsigned char)paletteSize;
+            palette[paletteSize++] = value;
+        }
+        shortTokenBytes += run <= SHORT_RUN ? 1 : 1 + GetVarintSize(run - SHORT_RUN - 1);
+        longTokenBytes += 1 + GetVarintSize(run - 1);
+        i += run;
+    }
+
+    if (paletteSize <= 1) {
+        output.push_back(MODE_UNIFORM);
+        output.push_back(count > 0 ? palette[0] : 0);
+        return;
+    }
+
+    const bool smallPalette = paletteSize <= SMALL_PALETTE;
+    const int paletteBytes = 1 + paletteSize;
+    const int runsSize = paletteBytes + (smallPalette ? shortTokenBytes : longTokenBytes);
+    const int packedSize = smallPalette ? paletteBytes + (count * GetIndexBits(paletteSize) + 7) / 8 : INT_MAX;
+    const int rawSize = count;
+
+    if (rawSize < runsSize && rawSize < packedSize) {
+        output.push_back(MODE_RAW);
+        output.insert(output.end(), data, data + count);
+        return;
+    }
+
+    const SectionMode mode = runsSize <= packedSize ? MODE_RUNS : MODE_PACKED;
+    output.push_back(mode);
+    output.push_back((unsigned char)(paletteSize - 1));
+    output.insert(output.end(), palette, palette + paletteSize);
+
+    if (mode == MODE_PACKED) {
+        const int bits = GetIndexBits(paletteSize);
+        const int perByte = 8 / bits;
+        const size_t start = output.size();
+        output.resize(start + (count * bits + 7) / 8, 0);
+        unsigned char* packed = output.data() + start;
+        for (int i = 0; i < count; i++) {
+            packed[i / perByte] |= (unsigned char)(indices[data[i]] << ((i % perByte) * bits));
+        }
+        return;
+    }
+
+    for (int i = 0; i < count;) {
+        const unsigned char value = data[i];
+        int run = 1;
+        while (i + run < count && data[i + run] == value) run++;
+        if (!smallPalette) {
+            output.push_back(indices[value]);
+            PutVarint(output, run - 1);
+        }
+        else if (run <= SHORT_RUN) {
+            output.push_back((unsigned char)(indices[value] | (run - 1) << 4));
+        }
+        else {
+            output.push_back((unsigned char)(indices[value] | SHORT_RUN << 4));
+            PutVarint(output, run - SHORT_RUN - 1);
+        }
+        i += run;
+    }
+}
+
+int SectionCodec::Decode(const unsigned char* data, int size, unsigned char* output, int count) {
+    if (size < 2) return -1;
+
+    const unsigned char mode = data[0];
+    if (mode == MODE_UNIFORM) {
+        memset(output, data[1], count);
+        return 2;
+    }
+    if (mode == MODE_RAW) {
+        if (size < 1 + count) return -1;
+        memcpy(output, data + 1, count);
+        return 1 + count;
+    }
+
+    const int paletteSize = data[1] + 1;
+    const unsigned char* palette = data + 2;
+    int offset = 2 + paletteSize;
+    if (size < offset) return -1;
+
+    if (mode == MODE_PACKED) {
+        if (paletteSize > SMALL_PALETTE) return -1;
+        const int bits = GetIndexBits(paletteSize);
+        const int packedSize = (count * bits + 7) / 8;
+        if (size - offset < packedSize) return -1;
+
+        unsigned char table[SMALL_PALETTE] = {};
+        memcpy(table, palette, paletteSize);
+        UnpackIndices(data + offset, bits, table, output, count);
+        return offset + packedSize;
+    }
+    if (mode != MODE_RUNS) return -1;
+
+    const bool smallPalette = paletteSize <= SMALL_PALETTE;
+    int written = 0;
+    while (written < count) {
+        if (offset >= size) return -1;
+        unsigned int index;
+        unsigned int run;
+        unsigned int length;
+        if (smallPalette) {
+            const unsigned char token = data[offset++];
+            index = token & 0x0F;
+            run = (token >> 4) + 1;
+            if (run > (unsigned int)SHORT_RUN) {
+                const int read = GetVarint(data + offset, size - offset, length);
+                if (!read || length > (unsigned int)count) return -1;
+                offset += read;
+                run = length + SHORT_RUN + 1;
+            }
+        }
+        else {
+            index = data[offset++];
+            const int read = GetVarint(data + offset, size - offset, length);
+            if (!read || length > (unsigned int)count) return -1;
+            offset += read;
+            run = length + 1;
+        }
+
+        if (index >= (unsigned int)paletteSize || run > (unsigned int)(count - written)) return -1;
+        memset(output + written, palette[index], run);
+        written += run;
+    }
+    return offset;
+}
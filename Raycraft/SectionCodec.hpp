@@ -0,0 +1,25 @@
+#ifndef SECTION_CODEC_HPP
+#define SECTION_CODEC_HPP
+
+#include <vector>
+
+// Compact encoding of one chunk section's bytes (block types, or state nibble pairs) in
+// storage order. The distinct values form a palette, and the section is stored in
+// whichever form is smallest:
+//   uniform  the one value
+//   runs     palette, then runs of palette indices; with up to 16 entries a run of up
+//            to 15 is one byte, index in the low nibble and length - 1 in the high one
+//   packed   palette, then 1, 2 or 4 bits per index, decoded with SSSE3 where available
+//   raw      the bytes as they are, when that is smaller than every other form
+// Generated terrain is mostly whole layers of air or stone and short rows around the
+// surface, so sections shrink to a few bytes or a byte per run.
+namespace SectionCodec {
+    // Appends the encoding of count bytes to output
+    void Encode(const unsigned char* data, int count, std::vector<unsigned char>& output);
+
+    // Decodes one section of count bytes from the start of data. Returns how many encoded
+    // bytes it took, or -1 if they are malformed or run past size.
+    int Decode(const unsigned char* data, int size, unsigned char* output, int count);
+}
+
+#endif
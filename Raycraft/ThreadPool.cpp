@@ -0,0 +1,82 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threadCount)
+    : job(nullptr), jobCount(0), jobGrain(1), nextIndex(0), busyWorkers(0), generation(0), stopping(false) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1, (int)std::thread::hardware_concurrency()) - 1;
+    }
+
+    for (int i = 0; i < threadCount; i++) {
+        threads.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::ParallelFor(int count, int grain, const std::function<void(int, int)>& fn) {
+    if (count <= 0) return;
+    grain = std::max(1, grain);
+
+    // Not worth waking anyone for a single range
+    if (threads.empty() || count <= grain) {
+        fn(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobCount = count;
+        jobGrain = grain;
+        nextIndex = 0;
+        busyWorkers = (int)threads.size();
+        generation++;
+    }
+    wakeWorkers.notify_all();
+
+    RunRanges();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    jobFinished.wait(lock, [this] { return busyWorkers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+    unsigned int seenGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeWorkers.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+
+        RunRanges();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+        }
+        jobFinished.notify_one();
+    }
+}
+
+void ThreadPool::RunRanges() {
+    // Ranges are claimed dynamically so uneven work (long vs. short rays) balances out
+    while (true) {
+        int begin = nextIndex.fetch_add(jobGrain);
+        if (begin >= jobCount) return;
+        (*job)(begin, std::min(begin + jobGrain, jobCount));
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent worker threads for data-parallel loops. One ParallelFor runs at a time;
+// the calling thread works alongside the workers and returns once every range is done.
+class ThreadPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable jobFinished;
+
+    // Current job, published under the mutex
+    const std::function<void(int, int)>* job;
+    int jobCount;
+    int jobGrain;
+    std::atomic<int> nextIndex;
+    int busyWorkers;
+    unsigned int generation;
+    bool stopping;
+
+public:
+    // threadCount 0 picks one worker per hardware thread, minus the caller
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Calls fn(begin, end) over [0, count) in ranges of at most grain items
+    void ParallelFor(int count, int grain, const std::function<void(int, int)>& fn);
+
+    int GetThreadCount() const { return (int)threads.size() + 1; }
+
+private:
+    void WorkerLoop();
+    void RunRanges();
+};
+
+#endif
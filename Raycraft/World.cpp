@@ -1,123 +1,1188 @@
 #include "World.hpp"
+#include "rlgl.h"
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
 #include <algorithm>
 #include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <unordered_set>
+#include <mutex>
 
 // ==================== CHUNK IMPLEMENTATION ====================
 
-Chunk::Chunk(int chunkX, int chunkZ)
-    : x(chunkX), z(chunkZ), dirty(true), initialized(false) {
-    blocks.resize(CHUNK_SIZE * WORLD_HEIGHT * CHUNK_SIZE, Block(BLOCK_AIR));
+namespace {
+    // Camera travel before a chunk re-sorts its translucent faces
+    const float TRANSLUCENT_RESORT_DISTANCE = 1.0f;
+
+    // Cube face description: neighbour offset, CCW corners seen from outside, shade
+    struct FaceInfo {
+        int dx, dy, dz;
+        float corners[4][3];
+        float shade;
+    };
+
+    const FaceInfo CUBE_FACES[6] = {
+        {  1,  0,  0, { {1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1} }, 0.8f  },
+        { -1,  0,  0, { {0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0} }, 0.8f  },
+        {  0,  1,  0, { {0, 1, 0}, {0, 1, 1}, {1, 1, 1}, {1, 1, 0} }, 1.0f  },
+        {  0, -1,  0, { {0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1} }, 0.5f  },
+        {  0,  0,  1, { {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1} }, 0.65f },
+        {  0,  0, -1, { {0, 0, 0}, {0, 1, 0}, {1, 1, 0}, {1, 0, 0} }, 0.65f }
+    };
+
+    // CUBE_FACES as seen by a log along each BlockAxis: faces borrow the shade of the face
+    // they stand in for, so the end grain is lit like the top of an upright log
+    std::array<std::array<FaceInfo, 6>, 3> BuildAxisFaces() {
+        const int shadeFaces[3][6] = { { 0, 1, 2, 3, 4, 5 }, { 2, 3, 0, 1, 4, 5 }, { 0, 1, 4, 5, 2, 3 } };
+        std::array<std::array<FaceInfo, 6>, 3> faces;
+        for (int axis = 0; axis < 3; axis++) {
+            for (int f = 0; f < 6; f++) {
+                faces[axis][f] = CUBE_FACES[f];
+                faces[axis][f].shade = CUBE_FACES[shadeFaces[axis][f]].shade;
+            }
+        }
+        return faces;
+    }
+    const std::array<std::array<FaceInfo, 6>, 3> AXIS_FACES = BuildAxisFaces();
+
+    // Snapshot index offset of each face's neighbour, in CUBE_FACES order
+    const int FACE_STRIDES[6] = {
+        1, -1, ChunkSnapshot::STRIDE_Y, -ChunkSnapshot::STRIDE_Y, ChunkSnapshot::STRIDE_Z, -ChunkSnapshot::STRIDE_Z
+    };
+
+    // Two triangles per quad, no index buffer so chunks are not limited to 65k vertices
+    const int QUAD_ORDER[6] = { 0, 1, 2, 0, 2, 3 };
+
+    // Appends a face of a size x height x size box with its minimum corner at (x, y, z)
+    void AppendFace(std::vector<float>& vertices, std::vector<unsigned char>& colors,
+        const FaceInfo& face, float x, float y, float z, float size, float height, Color color) {
+        unsigned char r = (unsigned char)(color.r * face.shade);
+        unsigned char g = (unsigned char)(color.g * face.shade);
+        unsigned char b = (unsigned char)(color.b * face.shade);
+
+        for (int i = 0; i < 6; i++) {
+            const float* corner = face.corners[QUAD_ORDER[i]];
+            vertices.push_back(x + corner[0] * size);
+            vertices.push_back(y + corner[1] * height);
+            vertices.push_back(z + corner[2] * size);
+            colors.push_back(r);
+            colors.push_back(g);
+            colors.push_back(b);
+            colors.push_back(color.a);
+        }
+    }
+
+    Mesh BuildMesh(const std::vector<float>& vertices, const std::vector<unsigned char>& colors, bool dynamic) {
+        Mesh mesh = { 0 };
+        mesh.vertexCount = (int)(vertices.size() / 3);
+        mesh.triangleCount = mesh.vertexCount / 3;
+        mesh.vertices = (float*)RL_MALLOC(vertices.size() * sizeof(float));
+        mesh.colors = (unsigned char*)RL_MALLOC(colors.size());
+        std::copy(vertices.begin(), vertices.end(), mesh.vertices);
+        std::copy(colors.begin(), colors.end(), mesh.colors);
+        UploadMesh(&mesh, dynamic);
+        return mesh;
+    }
 }
 
-Chunk::~Chunk() {
-    if (initialized) {
-        UnloadModel(model);
-        UnloadMesh(mesh);
+Chunk::Chunk(Block* storage)
+    : x(0), z(0), blocks(storage), storage(storage), dirty(true), modified(false), unsaved(false), meshLod(0),
+    version(0), meshVersion(0), neighbors{},
+    opaqueMesh{ 0 }, translucentMesh{ 0 },
+    hasOpaqueMesh(false), hasTranslucentMesh(false),
+    lastSortPosition{ 0, 0, 0 }, brickOccupancy{},
+    snapshotSource(nullptr), snapshotCopy(nullptr), sharedSections(0) {
+}
+
+void Chunk::Reset(int chunkX, int chunkZ) {
+    DetachSnapshot();
+    UnloadMeshes();
+    x = chunkX;
+    z = chunkZ;
+    dirty = true;
+    modified = false;
+    unsaved = false;
+    meshLod = 0;
+    version = 0;
+    meshVersion = 0;
+    std::fill_n(neighbors, NEIGHBOR_COUNT, nullptr);
+
+    // Translucent buffers keep their capacity for the next mesh build
+    translucentVertices.clear();
+    translucentColors.clear();
+    translucentFaces.clear();
+    lastSortPosition = { 0, 0, 0 };
+
+    blocks = storage;
+    brickOccupancy.fill(0);
+    states.reset();
+}
+
+void Chunk::Unmap() {
+    if (!IsMapped()) return;
+    std::copy_n(blocks, CHUNK_VOLUME, storage);
+    blocks = storage;
+}
+
+void Chunk::CopyBlocksFrom(const Chunk& source) {
+    std::copy_n(source.blocks, CHUNK_VOLUME, storage);
+    blocks = storage;
+    brickOccupancy = source.brickOccupancy;
+    modified = source.modified;
+
+    if (source.states) {
+        if (!states) states = std::make_unique<unsigned char[]>(STATE_BYTES);
+        std::copy_n(source.states.get(), STATE_BYTES, states.get());
+    }
+    else {
+        states.reset();
     }
 }
 
+namespace {
+    // Guards sharedSections of every snapshot; held for one section copy at a time
+    std::mutex snapshotMutex;
+
+    const uint32_t ALL_SECTIONS = (uint32_t)((1ull << SECTION_COUNT) - 1);
+}
+
+void Chunk::SnapshotFrom(Chunk& source) {
+    if (source.IsMapped()) {
+        CopyBlocksFrom(source);
+        return;
+    }
+
+    // A chunk feeds one snapshot at a time, so an older one takes the rest of its sections now
+    if (source.snapshotCopy) source.DetachSnapshot();
+
+    brickOccupancy = source.brickOccupancy;
+    modified = source.modified;
+    if (source.states) {
+        if (!states) states = std::make_unique<unsigned char[]>(STATE_BYTES);
+    }
+    else {
+        states.reset();
+    }
+    snapshotSource = &source;
+    source.snapshotCopy = this;
+    sharedSections = ALL_SECTIONS;
+}
+
+void Chunk::ResolveSnapshot() {
+    // The source's states are only replaced after DetachSnapshot, so they are stable while
+    // sections are shared. The link itself is cut by the source's thread once all are taken.
+    for (int section = 0; section < SECTION_COUNT; section++) {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        if (!(sharedSections & (1u << section))) continue;
+        const int first = section * SECTION_VOLUME;
+        std::copy_n(snapshotSource->storage + first, SECTION_VOLUME, storage + first);
+        if (states) std::copy_n(snapshotSource->states.get() + first / 2, SECTION_VOLUME / 2, states.get() + first / 2);
+        sharedSections &= ~(1u << section);
+    }
+}
+
+void Chunk::HandOverSections(uint32_t sections) {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    Chunk* copy = snapshotCopy;
+    sections &= copy->sharedSections;
+    for (int section = 0; section < SECTION_COUNT; section++) {
+        if (!(sections & (1u << section))) continue;
+        const int first = section * SECTION_VOLUME;
+        std::copy_n(storage + first, SECTION_VOLUME, copy->storage + first);
+        if (copy->states) std::copy_n(states.get() + first / 2, SECTION_VOLUME / 2, copy->states.get() + first / 2);
+    }
+    copy->sharedSections &= ~sections;
+
+    // Fully taken, by either side; the link is only ever cut on this thread
+    if (!copy->sharedSections) {
+        copy->snapshotSource = nullptr;
+        snapshotCopy = nullptr;
+    }
+}
+
+void Chunk::DetachSnapshot() {
+    if (snapshotCopy) {
+        HandOverSections(ALL_SECTIONS);
+    }
+    if (snapshotSource) {
+        // Recycled before it was resolved; its contents no longer matter
+        if (snapshotSource->snapshotCopy == this) snapshotSource->snapshotCopy = nullptr;
+        snapshotSource = nullptr;
+        sharedSections = 0;
+    }
+}
+
+void Chunk::RecomputeOccupancy() {
+    brickOccupancy.fill(0);
+    for (int by = 0; by < WORLD_HEIGHT; by += BRICK_SIZE) {
+        for (int bz = 0; bz < CHUNK_SIZE; bz += BRICK_SIZE) {
+            for (int bx = 0; bx < CHUNK_SIZE; bx += BRICK_SIZE) {
+                if (ScanBrick(bx, by, bz)) {
+                    brickOccupancy[by / SECTION_HEIGHT] |= GetBrickBit(bx, by, bz);
+                }
+            }
+        }
+    }
+}
+
+Chunk::~Chunk() {
+    UnloadMeshes();
+}
+
 Block Chunk::GetBlock(int x, int y, int z) const {
     if (x < 0 || x >= CHUNK_SIZE || y < 0 || y >= WORLD_HEIGHT || z < 0 || z >= CHUNK_SIZE) {
         return Block(BLOCK_AIR);
     }
-    return blocks[(y * CHUNK_SIZE + z) * CHUNK_SIZE + x];
+    return blocks[ChunkDims::Index(x, y, z)];
 }
 
-void Chunk::SetBlock(int x, int y, int z, Block block) {
+void Chunk::SetBlock(int x, int y, int z, Block block, unsigned char state) {
     if (x < 0 || x >= CHUNK_SIZE || y < 0 || y >= WORLD_HEIGHT || z < 0 || z >= CHUNK_SIZE) {
         return;
     }
-    blocks[(y * CHUNK_SIZE + z) * CHUNK_SIZE + x] = block;
-    dirty = true;
+    // Copy-on-write: a mapped chunk takes its blocks into the pool on the first edit, and
+    // a snapshot still sharing this section gets its old contents first
+    if (blocks != storage) Unmap();
+    if (snapshotCopy) HandOverSections(1u << (y / SECTION_HEIGHT));
+
+    const int index = ChunkDims::Index(x, y, z);
+    storage[index] = block;
+    version++;
+
+    // Stateless writes into a chunk without states stay on the byte-only path
+    if (states || state != 0) {
+        WriteState(index, block.IsStateful() ? state & BLOCK_STATE_MASK : 0);
+    }
+
+    // Filling a brick only sets its bit; emptying one needs a rescan of its 64 blocks
+    uint64_t& section = brickOccupancy[y / SECTION_HEIGHT];
+    if (block.IsSolid()) {
+        section |= GetBrickBit(x, y, z);
+    }
+    else if ((section & GetBrickBit(x, y, z)) && !ScanBrick(x, y, z)) {
+        section &= ~GetBrickBit(x, y, z);
+    }
+}
+
+unsigned char Chunk::GetState(int x, int y, int z) const {
+    if (!states || x < 0 || x >= CHUNK_SIZE || y < 0 || y >= WORLD_HEIGHT || z < 0 || z >= CHUNK_SIZE) {
+        return 0;
+    }
+    const int index = ChunkDims::Index(x, y, z);
+    return (states[index >> 1] >> ((index & 1) * BLOCK_STATE_BITS)) & BLOCK_STATE_MASK;
 }
 
-// Simplified mesh generation - we'll use immediate mode for now
-void Chunk::GenerateMesh() {
-    // Empty for now - we'll draw cubes directly
+void Chunk::WriteState(int index, unsigned char state) {
+    if (!states) {
+        if (state == 0) return;
+        states = std::make_unique<unsigned char[]>(STATE_BYTES);
+    }
+    const int shift = (index & 1) * BLOCK_STATE_BITS;
+    unsigned char& pair = states[index >> 1];
+    pair = (unsigned char)((pair & ~(BLOCK_STATE_MASK << shift)) | (state << shift));
+}
+
+Chunk* Chunk::GetNeighbor(int dx, int dz) const {
+    Chunk* sideX = dx > 0 ? neighbors[0] : (dx < 0 ? neighbors[1] : nullptr);
+    Chunk* sideZ = dz > 0 ? neighbors[2] : (dz < 0 ? neighbors[3] : nullptr);
+    if (dz == 0) return sideX;
+    if (dx == 0) return sideZ;
+
+    // Diagonals go through whichever side neighbour is loaded
+    if (sideX) return sideX->neighbors[dz > 0 ? 2 : 3];
+    if (sideZ) return sideZ->neighbors[dx > 0 ? 0 : 1];
+    return nullptr;
+}
+
+bool Chunk::ScanBrick(int x, int y, int z) const {
+    const int baseX = x - x % BRICK_SIZE;
+    const int baseY = y - y % BRICK_SIZE;
+    const int baseZ = z - z % BRICK_SIZE;
+
+    for (int by = baseY; by < baseY + BRICK_SIZE; by++) {
+        for (int bz = baseZ; bz < baseZ + BRICK_SIZE; bz++) {
+            for (int bx = baseX; bx < baseX + BRICK_SIZE; bx++) {
+                if (blocks[ChunkDims::Index(bx, by, bz)].IsSolid()) return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Chunk::GenerateMesh(const ChunkSnapshot& snapshot) {
+    UnloadMeshes();
+    meshLod = 0;
+    meshVersion = snapshot.version;
     dirty = false;
+
+    std::vector<float> opaqueVertices;
+    std::vector<unsigned char> opaqueColors;
+    translucentVertices.clear();
+    translucentColors.clear();
+    translucentFaces.clear();
+
+    const int baseX = x * CHUNK_SIZE;
+    const int baseZ = z * CHUNK_SIZE;
+
+    for (int ly = 0; ly < WORLD_HEIGHT; ly++) {
+        for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+            for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+                const int index = ChunkSnapshot::Index(lx, ly, lz);
+                Block block = snapshot.blocks[index];
+                if (!block.IsVisible()) continue;
+
+                const bool translucent = block.IsTranslucent();
+                const Color color = block.GetColor();
+                const float wx = (float)(baseX + lx);
+                float wy = (float)ly;
+                const float wz = (float)(baseZ + lz);
+                const unsigned char state = block.IsStateful() ? snapshot.GetState(index) : 0;
+
+                // Water surface sits slightly below the block top, lower as the level drops
+                float topHeight = 1.0f;
+                if (block.type == BLOCK_WATER && snapshot.blocks[index + ChunkSnapshot::STRIDE_Y].type != BLOCK_WATER) {
+                    topHeight = 0.9f * (WATER_LEVELS - std::min<int>(state, WATER_LEVELS - 1)) / WATER_LEVELS;
+                }
+
+                // Slabs fill half the cell, so the face on their open side is always exposed
+                int openFace = -1;
+                if (block.type == BLOCK_SLAB) {
+                    const BlockExtent extent = GetBlockExtent(block.type, state);
+                    wy += extent.bottom;
+                    topHeight = extent.top - extent.bottom;
+                    openFace = state == SLAB_TOP ? 3 : 2;
+                }
+                const FaceInfo* faces = block.type == BLOCK_WOOD && state <= BLOCK_AXIS_Z ? AXIS_FACES[state].data() : CUBE_FACES;
+
+                for (int f = 0; f < 6; f++) {
+                    const FaceInfo& face = faces[f];
+                    Block neighbor = snapshot.blocks[index + FACE_STRIDES[f]];
+
+                    // Faces between blocks of the same translucent type are never visible.
+                    // Slabs still show their open side and sides facing a slab in the other half.
+                    if (!neighbor.IsTransparent() || neighbor.type == block.type) {
+                        if (openFace < 0 || (f != openFace && (neighbor.type != block.type
+                            || snapshot.GetState(index + FACE_STRIDES[f]) == state))) continue;
+                    }
+
+                    if (translucent) {
+                        translucentFaces.push_back({
+                            { wx + 0.5f + face.dx * 0.5f, wy + 0.5f + face.dy * 0.5f, wz + 0.5f + face.dz * 0.5f },
+                            (int)(translucentVertices.size() / 3)
+                        });
+                        AppendFace(translucentVertices, translucentColors, face, wx, wy, wz, 1.0f, topHeight, color);
+                    }
+                    else {
+                        AppendFace(opaqueVertices, opaqueColors, face, wx, wy, wz, 1.0f, topHeight, color);
+                    }
+                }
+            }
+        }
+    }
+
+    if (!opaqueVertices.empty()) {
+        opaqueMesh = BuildMesh(opaqueVertices, opaqueColors, false);
+        // Opaque geometry never changes after upload, drop the CPU copy
+        RL_FREE(opaqueMesh.vertices);
+        RL_FREE(opaqueMesh.colors);
+        opaqueMesh.vertices = nullptr;
+        opaqueMesh.colors = nullptr;
+        hasOpaqueMesh = true;
+    }
+
+    if (!translucentVertices.empty()) {
+        translucentMesh = BuildMesh(translucentVertices, translucentColors, true);
+        hasTranslucentMesh = true;
+        // Force a sort on the next draw
+        lastSortPosition = { 1e9f, 1e9f, 1e9f };
+    }
 }
 
-void Chunk::Draw() {
-    // We don't use this for now - drawing is handled by OptimizedWorld
+void Chunk::GenerateLodMesh(int lod) {
+    UnloadMeshes();
+    meshLod = lod;
+    meshVersion = version;
+    dirty = false;
+
+    const int scale = 1 << lod;
+    const int cellsXZ = CHUNK_SIZE / scale;
+    const int cellsY = WORLD_HEIGHT / scale;
+    const int cellVolume = scale * scale * scale;
+    const float size = (float)scale;
+
+    // Majority-vote downsampling: a cell is filled when at least half of its voxels are,
+    // using the most common non-air type
+    std::vector<Block> cells(cellsXZ * cellsY * cellsXZ, Block(BLOCK_AIR));
+    auto cellIndex = [cellsXZ](int cx, int cy, int cz) { return (cy * cellsXZ + cz) * cellsXZ + cx; };
+
+    for (int cy = 0; cy < cellsY; cy++) {
+        for (int cz = 0; cz < cellsXZ; cz++) {
+            for (int cx = 0; cx < cellsXZ; cx++) {
+                int counts[BLOCK_COUNT] = { 0 };
+                int filled = 0;
+                for (int dy = 0; dy < scale; dy++) {
+                    for (int dz = 0; dz < scale; dz++) {
+                        for (int dx = 0; dx < scale; dx++) {
+                            Block block = GetBlock(cx * scale + dx, cy * scale + dy, cz * scale + dz);
+                            if (block.type != BLOCK_AIR) {
+                                counts[block.type]++;
+                                filled++;
+                            }
+                        }
+                    }
+                }
+                if (filled * 2 < cellVolume) continue;
+
+                unsigned char best = BLOCK_AIR;
+                for (int type = 1; type < BLOCK_COUNT; type++) {
+                    if (counts[type] > counts[best]) best = (unsigned char)type;
+                }
+                cells[cellIndex(cx, cy, cz)] = Block(best);
+            }
+        }
+    }
+
+    // Distant geometry is drawn in the opaque pass only; translucent cells become solid
+    std::vector<float> vertices;
+    std::vector<unsigned char> colors;
+    const float baseX = (float)(x * CHUNK_SIZE);
+    const float baseZ = (float)(z * CHUNK_SIZE);
+
+    for (int cy = 0; cy < cellsY; cy++) {
+        for (int cz = 0; cz < cellsXZ; cz++) {
+            for (int cx = 0; cx < cellsXZ; cx++) {
+                Block cell = cells[cellIndex(cx, cy, cz)];
+                if (cell.type == BLOCK_AIR) continue;
+
+                Color color = cell.GetColor();
+                color.a = 255;
+
+                for (const FaceInfo& face : CUBE_FACES) {
+                    int nx = cx + face.dx;
+                    int ny = cy + face.dy;
+                    int nz = cz + face.dz;
+
+                    // Chunk borders are covered by skirts since the neighbour may use another LOD
+                    if (ny < 0 || nx < 0 || nx >= cellsXZ || nz < 0 || nz >= cellsXZ) continue;
+                    if (ny < cellsY && cells[cellIndex(nx, ny, nz)].type != BLOCK_AIR) continue;
+
+                    AppendFace(vertices, colors, face, baseX + cx * size, cy * size, baseZ + cz * size, size, size, color);
+                }
+            }
+        }
+    }
+
+    // Skirts: hang a two-cell curtain below the surface along each chunk border to hide
+    // cracks against neighbours meshed at a different resolution
+    for (int side = 0; side < 4; side++) {
+        const FaceInfo& face = CUBE_FACES[side < 2 ? side : side + 2];  // +X, -X, +Z, -Z
+
+        for (int i = 0; i < cellsXZ; i++) {
+            int cx = face.dx > 0 ? cellsXZ - 1 : face.dx < 0 ? 0 : i;
+            int cz = face.dz > 0 ? cellsXZ - 1 : face.dz < 0 ? 0 : i;
+
+            int top = cellsY - 1;
+            while (top >= 0 && cells[cellIndex(cx, top, cz)].type == BLOCK_AIR) top--;
+            if (top < 0) continue;
+
+            Color color = cells[cellIndex(cx, top, cz)].GetColor();
+            color.a = 255;
+
+            float skirtTop = (top + 1) * size;
+            float skirtBottom = std::max(0.0f, skirtTop - 2.0f * size);
+            AppendFace(vertices, colors, face, baseX + cx * size, skirtBottom, baseZ + cz * size,
+                size, skirtTop - skirtBottom, color);
+        }
+    }
+
+    if (!vertices.empty()) {
+        opaqueMesh = BuildMesh(vertices, colors, false);
+        RL_FREE(opaqueMesh.vertices);
+        RL_FREE(opaqueMesh.colors);
+        opaqueMesh.vertices = nullptr;
+        opaqueMesh.colors = nullptr;
+        hasOpaqueMesh = true;
+    }
+}
+
+void Chunk::SortTranslucentFaces(Vector3 cameraPos) {
+    if (!hasTranslucentMesh) return;
+    if (Vector3DistanceSqr(cameraPos, lastSortPosition) < TRANSLUCENT_RESORT_DISTANCE * TRANSLUCENT_RESORT_DISTANCE) return;
+
+    lastSortPosition = cameraPos;
+
+    // Back-to-front: farthest face first
+    std::sort(translucentFaces.begin(), translucentFaces.end(),
+        [cameraPos](const TranslucentFace& a, const TranslucentFace& b) {
+            return Vector3DistanceSqr(a.center, cameraPos) > Vector3DistanceSqr(b.center, cameraPos);
+        });
+
+    int vertex = 0;
+    for (const TranslucentFace& face : translucentFaces) {
+        std::copy_n(translucentVertices.begin() + face.firstVertex * 3, 6 * 3, translucentMesh.vertices + vertex * 3);
+        std::copy_n(translucentColors.begin() + face.firstVertex * 4, 6 * 4, translucentMesh.colors + vertex * 4);
+        vertex += 6;
+    }
+
+    UpdateMeshBuffer(translucentMesh, 0, translucentMesh.vertices, translucentMesh.vertexCount * 3 * sizeof(float), 0);
+    UpdateMeshBuffer(translucentMesh, RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, translucentMesh.colors, translucentMesh.vertexCount * 4, 0);
+}
+
+void Chunk::UnloadMeshes() {
+    if (hasOpaqueMesh) {
+        UnloadMesh(opaqueMesh);
+        opaqueMesh = { 0 };
+        hasOpaqueMesh = false;
+    }
+    if (hasTranslucentMesh) {
+        UnloadMesh(translucentMesh);
+        translucentMesh = { 0 };
+        hasTranslucentMesh = false;
+    }
+}
+
+void Chunk::DrawOpaque(const Material& material) const {
+    if (hasOpaqueMesh) {
+        DrawMesh(opaqueMesh, material, MatrixIdentity());
+    }
+}
+
+void Chunk::DrawTranslucent(const Material& material) const {
+    if (hasTranslucentMesh) {
+        DrawMesh(translucentMesh, material, MatrixIdentity());
+    }
 }
 
 // ==================== WORLD IMPLEMENTATION ====================
 
-OptimizedWorld::OptimizedWorld(int worldSeed) : seed(worldSeed), cacheDirty(true) {
-    srand(seed);
+OptimizedWorld::OptimizedWorld(int worldSeed)
+    : chunks(GRID_SIZE * GRID_SIZE, nullptr), fixedBlocks(nullptr), centerX(0), centerZ(0),
+    renderDistance(MIN_RENDER_DISTANCE), loadDistance(MIN_RENDER_DISTANCE + 1), windowLoaded(false),
+    seed(worldSeed), saveFormat(REGION_COMPRESSED), journalEdits(0), materialLoaded(false), renderStats{} {
+    // Chunks are generated lazily once the first player position is known
+}
+
+OptimizedWorld::~OptimizedWorld() {
+    // Chunks themselves are owned and destroyed by the pool; queued writes still land
+    if (chunkIO) {
+        CancelReads();
+        FlushIO();
+    }
+    UnloadRenderData();
+}
+
+void OptimizedWorld::Update(Vector3 playerPos) {
+    auto [chunkX, chunkZ] = WorldToChunkPos((int)floorf(playerPos.x), (int)floorf(playerPos.z));
+
+    // Chunks read since the last frame join the window, and new reads go nearest first
+    if (chunkIO) {
+        chunkIO->Poll();
+        chunkIO->SetFocus(chunkX, chunkZ);
+    }
+
+    // Far ring first so chunks generated by the slide below refine tiles at the new position
+    farTerrain.Update(*this, chunkX, chunkZ, renderDistance);
+
+    if (!windowLoaded || chunkX != centerX || chunkZ != centerZ) {
+        SlideWindow(chunkX, chunkZ);
+    }
+
+    // Rebuild meshes of dirty chunks inside the render distance, nearest rings first,
+    // so a jump in render distance is spread over several frames. A chunk whose ring
+    // moved into another LOD band is rebuilt lazily at its new level; until then it
+    // keeps drawing the old mesh. A chunk whose neighbours are still being read waits for
+    // them, so its border faces are not built against missing blocks.
+    int meshBuilds = 0;
+    for (int ring = 0; ring <= renderDistance && meshBuilds < MESH_BUILDS_PER_FRAME; ring++) {
+        const int lod = GetLodForRing(ring);
+        ForEachInRing(centerX, centerZ, ring, [&](int cx, int cz) {
+            Chunk* chunk = GetChunkAt(cx, cz);
+            if (chunk && chunk->NeedsMesh(lod) && meshBuilds < MESH_BUILDS_PER_FRAME && !IsWaitingForNeighbors(*chunk)) {
+                if (lod == 0) {
+                    SnapshotChunk(*chunk, meshSnapshot);
+                    chunk->GenerateMesh(meshSnapshot);
+                }
+                else {
+                    chunk->GenerateLodMesh(lod);
+                }
+                meshBuilds++;
+            }
+        });
+    }
+
+    if (chunkIO) {
+        SubmitJournalBatch();
+        SubmitWriteBatch();
+        if (journalEdits >= JOURNAL_COMPACT_EDITS) CompactJournal();
+    }
+}
+
+int OptimizedWorld::GetLodForRing(int ring) const {
+    if (ring >= LOD_4X_DISTANCE) return 2;
+    if (ring >= LOD_2X_DISTANCE) return 1;
+    return 0;
+}
+
+void OptimizedWorld::SetRenderDistance(int distance) {
+    distance = std::clamp(distance, MIN_RENDER_DISTANCE, MAX_RENDER_DISTANCE);
+    if (!windowLoaded) {
+        renderDistance = distance;
+        loadDistance = distance + 1;
+        return;
+    }
 
-    // Initialize chunks
-    chunks.resize(CHUNK_COUNT_X, std::vector<Chunk*>(CHUNK_COUNT_Z, nullptr));
-    for (int x = 0; x < CHUNK_COUNT_X; x++) {
-        for (int z = 0; z < CHUNK_COUNT_Z; z++) {
-            chunks[x][z] = new Chunk(x, z);
+    // Only the rings crossing the boundary are touched; the old load ring is
+    // already generated and dirty, so it becomes renderable as is
+    while (renderDistance < distance) {
+        renderDistance++;
+        loadDistance++;
+        if constexpr (FIXED_WORLD_CHUNKS == 0) {
+            ForEachInRing(centerX, centerZ, loadDistance, [&](int cx, int cz) { LoadChunk(cx, cz); });
         }
     }
 
-    GenerateTerrain();
+    while (renderDistance > distance) {
+        if constexpr (FIXED_WORLD_CHUNKS == 0) {
+            ForEachInRing(centerX, centerZ, loadDistance, [&](int cx, int cz) { UnloadChunk(cx, cz); });
+        }
+        ForEachInRing(centerX, centerZ, renderDistance, [&](int cx, int cz) {
+            if (Chunk* chunk = GetChunkAt(cx, cz)) {
+                chunk->UnloadMeshes();
+                chunk->dirty = true;
+            }
+        });
+        renderDistance--;
+        loadDistance--;
+    }
 }
 
-OptimizedWorld::~OptimizedWorld() {
-    for (auto& row : chunks) {
-        for (auto chunk : row) {
-            delete chunk;
+void OptimizedWorld::SlideWindow(int newCenterX, int newCenterZ) {
+    // The fixed world is generated once; moving only changes which chunks keep meshes
+    if constexpr (FIXED_WORLD_CHUNKS > 0) {
+        if (!windowLoaded) {
+            LoadFixedWorld();
+        }
+        else {
+            for (int cz = centerZ - renderDistance; cz <= centerZ + renderDistance; cz++) {
+                for (int cx = centerX - renderDistance; cx <= centerX + renderDistance; cx++) {
+                    Chunk* chunk = GetChunkAt(cx, cz);
+                    if (chunk && std::max(abs(cx - newCenterX), abs(cz - newCenterZ)) > renderDistance) {
+                        chunk->UnloadMeshes();
+                        chunk->dirty = true;
+                    }
+                }
+            }
+        }
+
+        centerX = newCenterX;
+        centerZ = newCenterZ;
+        windowLoaded = true;
+        return;
+    }
+
+    // First load or a jump past the loaded square: nothing of the old window can be reused,
+    // and stepping there would load and drop every column in between
+    const int loadedWidth = 2 * loadDistance + 1;
+    if (!windowLoaded || abs(newCenterX - centerX) >= loadedWidth || abs(newCenterZ - centerZ) >= loadedWidth) {
+        CancelReads();
+        for (auto& chunk : chunks) {
+            ReleaseChunk(chunk);
+            chunk = nullptr;
+        }
+
+        centerX = newCenterX;
+        centerZ = newCenterZ;
+        for (int cz = centerZ - loadDistance; cz <= centerZ + loadDistance; cz++) {
+            for (int cx = centerX - loadDistance; cx <= centerX + loadDistance; cx++) {
+                LoadChunk(cx, cz);
+            }
+        }
+        windowLoaded = true;
+        return;
+    }
+
+    // Step one chunk at a time so only the edge column/row is touched
+    while (centerX != newCenterX) {
+        int step = newCenterX > centerX ? 1 : -1;
+
+        for (int cz = centerZ - loadDistance; cz <= centerZ + loadDistance; cz++) {
+            UnloadChunk(centerX - step * loadDistance, cz);
+            LoadChunk(centerX + step * (loadDistance + 1), cz);
+        }
+
+        // The trailing render column drops back to a mesh-less neighbour ring
+        for (int cz = centerZ - renderDistance; cz <= centerZ + renderDistance; cz++) {
+            if (Chunk* chunk = GetChunkAt(centerX - step * renderDistance, cz)) {
+                chunk->UnloadMeshes();
+                chunk->dirty = true;
+            }
+        }
+
+        centerX += step;
+    }
+
+    while (centerZ != newCenterZ) {
+        int step = newCenterZ > centerZ ? 1 : -1;
+
+        for (int cx = centerX - loadDistance; cx <= centerX + loadDistance; cx++) {
+            UnloadChunk(cx, centerZ - step * loadDistance);
+            LoadChunk(cx, centerZ + step * (loadDistance + 1));
+        }
+
+        for (int cx = centerX - renderDistance; cx <= centerX + renderDistance; cx++) {
+            if (Chunk* chunk = GetChunkAt(cx, centerZ - step * renderDistance)) {
+                chunk->UnloadMeshes();
+                chunk->dirty = true;
+            }
         }
+
+        centerZ += step;
     }
 }
 
-void OptimizedWorld::Update(Vector3 playerPos) {
-    // Update which blocks are visible based on player position
-    UpdateVisibleBlocks(playerPos);
-
-    // Update dirty chunks
-    for (auto& row : chunks) {
-        for (auto chunk : row) {
-            if (chunk->dirty) {
-                chunk->GenerateMesh();
+void OptimizedWorld::LoadFixedWorld() {
+    // Taking the chunk for slot i from index i of one contiguous run puts its blocks at
+    // i * CHUNK_VOLUME in a single allocation
+    Chunk* run = chunkPool.AcquireContiguous(FIXED_WORLD_CHUNKS * FIXED_WORLD_CHUNKS);
+    for (int cz = FIXED_WORLD_MIN_CHUNK; cz < FIXED_WORLD_MIN_CHUNK + FIXED_WORLD_CHUNKS; cz++) {
+        for (int cx = FIXED_WORLD_MIN_CHUNK; cx < FIXED_WORLD_MIN_CHUNK + FIXED_WORLD_CHUNKS; cx++) {
+            const int slot = GetWindowSlot(cx, cz);
+            ReleaseChunk(chunks[slot]);
+            chunks[slot] = nullptr;
+            run[slot].Reset(cx, cz);
+            FillChunk(&run[slot]);
+        }
+    }
+
+    // Every chunk must be in place before the block array is read directly
+    if (chunkIO) chunkIO->Flush();
+    fixedBlocks = run[0].storage;
+}
+
+void OptimizedWorld::LoadChunk(int chunkX, int chunkZ) {
+    int slot = GetWindowSlot(chunkX, chunkZ);
+    ReleaseChunk(chunks[slot]);
+
+    long long key = ((long long)chunkX << 32) | (unsigned int)chunkZ;
+    auto parked = parkedChunks.find(key);
+    if (parked != parkedChunks.end()) {
+        chunks[slot] = parked->second;
+        parkedChunks.erase(parked);
+        LinkNeighbors(chunks[slot]);
+        return;
+    }
+    if (pendingReads.count(key)) return;
+
+    FillChunk(chunkPool.Acquire(chunkX, chunkZ));
+}
+
+void OptimizedWorld::FillChunk(Chunk* chunk) {
+    // The fixed world indexes the pool buffers directly, so it always takes a copy
+    if (chunkIO) {
+        pendingReads[((long long)chunk->x << 32) | (unsigned int)chunk->z] = chunk;
+        chunkIO->RequestRead(chunk, FIXED_WORLD_CHUNKS == 0, [this](Chunk* read, bool found) { OnChunkRead(read, found); });
+        return;
+    }
+
+    GenerateChunk(*chunk);
+    chunks[GetWindowSlot(chunk->x, chunk->z)] = chunk;
+    LinkNeighbors(chunk);
+}
+
+void OptimizedWorld::OnChunkRead(Chunk* chunk, bool found) {
+    // Cancelled after the read had started
+    const long long key = ((long long)chunk->x << 32) | (unsigned int)chunk->z;
+    auto pending = pendingReads.find(key);
+    if (pending == pendingReads.end() || pending->second != chunk) {
+        chunkPool.Release(chunk);
+        return;
+    }
+    pendingReads.erase(pending);
+
+    if (found) {
+        farTerrain.RefineTile(*chunk);
+    }
+    else {
+        GenerateChunk(*chunk);
+    }
+    ReplayEdits(*chunk);
+
+    const int slot = GetWindowSlot(chunk->x, chunk->z);
+    ReleaseChunk(chunks[slot]);
+    chunks[slot] = chunk;
+    LinkNeighbors(chunk);
+}
+
+void OptimizedWorld::CancelReads() {
+    // Reads already running still call back; their chunks go back to the pool then
+    for (const auto& [key, chunk] : pendingReads) {
+        if (chunkIO->CancelRead(chunk)) chunkPool.Release(chunk);
+    }
+    pendingReads.clear();
+}
+
+bool OptimizedWorld::IsWaitingForNeighbors(const Chunk& chunk) const {
+    if (pendingReads.empty()) return false;
+    for (int d = 0; d < Chunk::NEIGHBOR_COUNT; d++) {
+        const int neighborX = chunk.x + Chunk::NEIGHBOR_OFFSETS[d][0];
+        const int neighborZ = chunk.z + Chunk::NEIGHBOR_OFFSETS[d][1];
+        if (pendingReads.count(((long long)neighborX << 32) | (unsigned int)neighborZ)) return true;
+    }
+    return false;
+}
+
+bool OptimizedWorld::IsWaitingForChunk(Vector3 worldPos) const {
+    auto [chunkX, chunkZ] = WorldToChunkPos((int)floorf(worldPos.x), (int)floorf(worldPos.z));
+    return pendingReads.count(((long long)chunkX << 32) | (unsigned int)chunkZ) != 0;
+}
+
+void OptimizedWorld::QueueChunkWrite(Chunk* chunk) {
+    // The I/O thread writes a snapshot, so the chunk stays free to edit
+    Chunk* copy = chunkPool.Acquire(chunk->x, chunk->z);
+    copy->SnapshotFrom(*chunk);
+    chunk->unsaved = false;
+    writesInFlight[((long long)chunk->x << 32) | (unsigned int)chunk->z]++;
+    writeBatch.push_back(copy);
+}
+
+void OptimizedWorld::SubmitWriteBatch() {
+    if (writeBatch.empty()) return;
+
+    // The region files written are replaced, taking their old mappings with them
+    std::unordered_set<long long> regions;
+    for (const Chunk* copy : writeBatch) {
+        regions.insert(RegionStore::GetRegionKey(copy->x, copy->z));
+    }
+    for (Chunk* chunk : chunks) {
+        if (chunk && chunk->IsMapped() && regions.count(RegionStore::GetRegionKey(chunk->x, chunk->z))) chunk->Unmap();
+    }
+    for (const auto& [key, chunk] : parkedChunks) {
+        if (chunk->IsMapped() && regions.count(RegionStore::GetRegionKey(chunk->x, chunk->z))) chunk->Unmap();
+    }
+
+    std::vector<Chunk*> copies;
+    copies.swap(writeBatch);
+    auto written = [this, copies](bool success) { OnChunksWritten(copies, success); };
+    chunkIO->QueueWrite(std::move(copies), saveFormat, std::move(written));
+}
+
+void OptimizedWorld::OnChunksWritten(const std::vector<Chunk*>& copies, bool success) {
+    for (Chunk* copy : copies) {
+        const long long key = ((long long)copy->x << 32) | (unsigned int)copy->z;
+        auto inFlight = writesInFlight.find(key);
+        const bool lastWrite = inFlight != writesInFlight.end() && --inFlight->second == 0;
+        if (lastWrite) writesInFlight.erase(inFlight);
+
+        auto parked = parkedChunks.find(key);
+        if (!success) {
+            // Tried again by the next compaction, which keeps the journal until then
+            if (parked != parkedChunks.end()) {
+                parked->second->unsaved = true;
+            }
+            else if (Chunk* chunk = GetChunkAt(copy->x, copy->z)) {
+                chunk->unsaved = true;
             }
         }
+        else if (lastWrite && parked != parkedChunks.end() && !parked->second->unsaved) {
+            // On disk now, so a later visit reads it back instead
+            chunkPool.Release(parked->second);
+            parkedChunks.erase(parked);
+        }
+        chunkPool.Release(copy);
+    }
+}
+
+void OptimizedWorld::SubmitJournalBatch() {
+    if (journalBatch.empty()) return;
+    journalEdits += (int)journalBatch.size();
+    chunkIO->AppendJournal(std::move(journalBatch));
+    journalBatch.clear();
+}
+
+void OptimizedWorld::CompactJournal() {
+    // Everything edited goes to the region files ahead of the compaction in the queue.
+    // Replayed edits of chunks not read since are in no region file, so they stay logged.
+    SubmitJournalBatch();
+    for (Chunk* chunk : chunks) {
+        if (chunk && chunk->unsaved) QueueChunkWrite(chunk);
+    }
+    for (const auto& [key, chunk] : parkedChunks) {
+        if (chunk->unsaved) QueueChunkWrite(chunk);
+    }
+    SubmitWriteBatch();
+
+    std::vector<JournalEdit> kept;
+    for (const auto& [key, edits] : journalReplay) {
+        kept.insert(kept.end(), edits.begin(), edits.end());
+    }
+    journalEdits = 0;
+    chunkIO->CompactJournal(std::move(kept));
+}
+
+void OptimizedWorld::ReplayEdits(Chunk& chunk) {
+    auto replay = journalReplay.find(((long long)chunk.x << 32) | (unsigned int)chunk.z);
+    if (replay == journalReplay.end()) return;
+
+    for (const JournalEdit& edit : replay->second) {
+        if (edit.index >= CHUNK_VOLUME || edit.type >= BLOCK_COUNT) continue;
+        const int x = edit.index % CHUNK_SIZE;
+        const int z = edit.index / CHUNK_SIZE % CHUNK_SIZE;
+        const int y = edit.index / (CHUNK_SIZE * CHUNK_SIZE);
+        chunk.SetBlock(x, y, z, Block(edit.type), edit.state);
+    }
+    chunk.modified = true;
+    chunk.unsaved = true;
+    farTerrain.RefineTile(chunk);
+    journalReplay.erase(replay);
+}
+
+void OptimizedWorld::UnloadChunk(int chunkX, int chunkZ) {
+    int slot = GetWindowSlot(chunkX, chunkZ);
+    Chunk* chunk = chunks[slot];
+    if (chunk && chunk->x == chunkX && chunk->z == chunkZ) {
+        ReleaseChunk(chunk);
+        chunks[slot] = nullptr;
+        return;
+    }
+
+    // Still being read: drop the request, or let the late result go back to the pool
+    auto pending = pendingReads.find(((long long)chunkX << 32) | (unsigned int)chunkZ);
+    if (pending != pendingReads.end()) {
+        if (chunkIO->CancelRead(pending->second)) chunkPool.Release(pending->second);
+        pendingReads.erase(pending);
     }
 }
 
-void OptimizedWorld::Draw() {
-    // Draw all visible blocks from cache
-    for (const auto& block : visibleBlocks) {
-        Vector3 pos = std::get<0>(block);
-        Color color = std::get<1>(block);
-        bool isWater = std::get<2>(block);
+void OptimizedWorld::ReleaseChunk(Chunk* chunk) {
+    if (!chunk) return;
+    UnlinkNeighbors(chunk);
+
+    if (chunk->modified) {
+        // The far ring keeps the edited surface once the voxels are gone
+        farTerrain.RefineTile(*chunk);
 
-        if (isWater) {
-            DrawCube(pos, 1.0f, 0.9f, 1.0f, color);
-            DrawCubeWires(pos, 1.0f, 0.9f, 1.0f, ColorAlpha(BLUE, 0.3f));
+        // With a save to write to, an edited chunk is only kept until it is on disk
+        const long long key = ((long long)chunk->x << 32) | (unsigned int)chunk->z;
+        if (chunkIO && !chunk->unsaved && !writesInFlight.count(key)) {
+            chunkPool.Release(chunk);
+            return;
         }
-        else {
-            DrawCube(pos, 1.0f, 1.0f, 1.0f, color);
-            DrawCubeWires(pos, 1.0f, 1.0f, 1.0f, ColorAlpha(BLACK, 0.1f));
+        chunk->UnloadMeshes();
+        chunk->dirty = true;
+        parkedChunks[key] = chunk;
+        if (chunkIO && chunk->unsaved) QueueChunkWrite(chunk);
+    }
+    else {
+        chunkPool.Release(chunk);
+    }
+}
+
+void OptimizedWorld::DiscardChunks() {
+    for (Chunk*& chunk : chunks) {
+        if (chunk) {
+            UnlinkNeighbors(chunk);
+            chunkPool.Release(chunk);
+            chunk = nullptr;
+        }
+    }
+    for (auto& [key, chunk] : parkedChunks) {
+        chunkPool.Release(chunk);
+    }
+    parkedChunks.clear();
+    fixedBlocks = nullptr;
+    windowLoaded = false;
+}
+
+void OptimizedWorld::LinkNeighbors(Chunk* chunk) {
+    for (int d = 0; d < Chunk::NEIGHBOR_COUNT; d++) {
+        Chunk* neighbor = GetChunkAt(chunk->x + Chunk::NEIGHBOR_OFFSETS[d][0], chunk->z + Chunk::NEIGHBOR_OFFSETS[d][1]);
+        chunk->neighbors[d] = neighbor;
+        if (neighbor) neighbor->neighbors[d ^ 1] = chunk;
+    }
+}
+
+void OptimizedWorld::UnlinkNeighbors(Chunk* chunk) {
+    for (int d = 0; d < Chunk::NEIGHBOR_COUNT; d++) {
+        if (chunk->neighbors[d]) {
+            chunk->neighbors[d]->neighbors[d ^ 1] = nullptr;
+            chunk->neighbors[d] = nullptr;
+        }
+    }
+}
+
+void OptimizedWorld::Draw(const Camera3D& camera) {
+    if (!materialLoaded) {
+        material = LoadMaterialDefault();
+        materialLoaded = true;
+    }
+
+    const Vector3 cameraPos = camera.position;
+    renderStats = {};
+
+    // Sort chunks by horizontal distance from the camera
+    drawOrder.clear();
+    for (int cz = centerZ - renderDistance; cz <= centerZ + renderDistance; cz++) {
+        for (int cx = centerX - renderDistance; cx <= centerX + renderDistance; cx++) {
+            Chunk* chunk = GetChunkAt(cx, cz);
+            if (!chunk || (!chunk->hasOpaqueMesh && !chunk->hasTranslucentMesh)) continue;
+
+            float dx = (chunk->x * CHUNK_SIZE + CHUNK_SIZE * 0.5f) - cameraPos.x;
+            float dz = (chunk->z * CHUNK_SIZE + CHUNK_SIZE * 0.5f) - cameraPos.z;
+            drawOrder.push_back({ dx * dx + dz * dz, chunk });
         }
     }
+    std::sort(drawOrder.begin(), drawOrder.end(),
+        [](const std::pair<float, Chunk*>& a, const std::pair<float, Chunk*>& b) { return a.first < b.first; });
+
+    // Opaque pass front-to-back so the depth test rejects hidden fragments early
+    for (const auto& entry : drawOrder) {
+        Chunk* chunk = entry.second;
+        chunk->DrawOpaque(material);
+        renderStats.chunksDrawn++;
+        renderStats.opaqueFaces += chunk->opaqueMesh.vertexCount / 6;
+        renderStats.lodTriangles[chunk->meshLod] += chunk->opaqueMesh.triangleCount + chunk->translucentMesh.triangleCount;
+    }
+
+    // Far terrain is behind every chunk, so it goes last in the opaque pass
+    farTerrain.Draw(material);
+
+    // Translucent pass back-to-front with depth writes off so blending stays correct
+    rlDisableDepthMask();
+    for (auto it = drawOrder.rbegin(); it != drawOrder.rend(); ++it) {
+        Chunk* chunk = it->second;
+        if (!chunk->hasTranslucentMesh) continue;
+
+        chunk->SortTranslucentFaces(cameraPos);
+        chunk->DrawTranslucent(material);
+        renderStats.translucentFaces += chunk->translucentMesh.vertexCount / 6;
+    }
+    rlEnableDepthMask();
 }
 
-Block OptimizedWorld::GetBlock(Vector3 worldPos) const {
-    int x = (int)floorf(worldPos.x);
-    int y = (int)floorf(worldPos.y);
-    int z = (int)floorf(worldPos.z);
+void OptimizedWorld::UnloadRenderData() {
+    for (auto chunk : chunks) {
+        if (chunk) {
+            chunk->UnloadMeshes();
+            chunk->dirty = true;
+        }
+    }
+    farTerrain.Unload();
+    if (materialLoaded) {
+        UnloadMaterial(material);
+        materialLoaded = false;
+    }
+}
 
+Block OptimizedWorld::GetBlock(int x, int y, int z) const {
     if (y < 0 || y >= WORLD_HEIGHT) return Block(BLOCK_AIR);
 
-    auto chunk = GetChunk(x, z);
+    auto [chunkX, chunkZ] = WorldToChunkPos(x, z);
+    const int localX = ChunkDims::ToLocal(x);
+    const int localZ = ChunkDims::ToLocal(z);
+
+    // Fixed world: straight into the shared block array, no chunk object involved
+    if constexpr (FIXED_WORLD_CHUNKS > 0) {
+        if (!fixedBlocks || !IsInFixedWorld(chunkX, chunkZ)) return Block(BLOCK_AIR);
+        return fixedBlocks[GetWindowSlot(chunkX, chunkZ) * CHUNK_VOLUME + ChunkDims::Index(localX, y, localZ)];
+    }
+
+    const Chunk* chunk = GetChunkAt(chunkX, chunkZ);
     if (!chunk) return Block(BLOCK_AIR);
 
-    auto [localX, localY, localZ] = WorldToLocalPos(x, y, z);
-    return chunk->GetBlock(localX, localY, localZ);
+    return chunk->GetBlock(localX, y, localZ);
+}
+
+void OptimizedWorld::SnapshotChunk(const Chunk& chunk, ChunkSnapshot& snapshot) const {
+    snapshot.chunkX = chunk.x;
+    snapshot.chunkZ = chunk.z;
+    snapshot.version = chunk.version;
+
+    // Solid floor below the world so bottom faces of the lowest layer are never emitted,
+    // open sky above it
+    std::fill_n(snapshot.blocks.begin(), ChunkSnapshot::STRIDE_Y, Block(BLOCK_STONE));
+    std::fill_n(snapshot.blocks.begin() + ChunkSnapshot::Index(-1, WORLD_HEIGHT, -1), ChunkSnapshot::STRIDE_Y, Block(BLOCK_AIR));
+
+    // The chunk itself and its eight neighbours, each copied row by row.
+    // Neighbours only contribute the one-block strip facing this chunk.
+    for (int dz = -1; dz <= 1; dz++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            const Chunk* source = (dx == 0 && dz == 0) ? &chunk : chunk.GetNeighbor(dx, dz);
+
+            const int firstX = dx < 0 ? -1 : (dx == 0 ? 0 : CHUNK_SIZE);
+            const int firstZ = dz < 0 ? -1 : (dz == 0 ? 0 : CHUNK_SIZE);
+            const int width = dx == 0 ? CHUNK_SIZE : 1;
+            const int depth = dz == 0 ? CHUNK_SIZE : 1;
+            const int sourceX = firstX - dx * CHUNK_SIZE;
+            const int sourceZ = firstZ - dz * CHUNK_SIZE;
+
+            for (int y = 0; y < WORLD_HEIGHT; y++) {
+                for (int z = 0; z < depth; z++) {
+                    auto destination = snapshot.blocks.begin() + ChunkSnapshot::Index(firstX, y, firstZ + z);
+                    if (!source) {
+                        std::fill_n(destination, width, Block(BLOCK_AIR));
+                    }
+                    else if constexpr (ChunkDims::ROWS_CONTIGUOUS) {
+                        std::copy_n(source->blocks + ChunkDims::Index(sourceX, y, sourceZ + z), width, destination);
+                    }
+                    else {
+                        for (int x = 0; x < width; x++) {
+                            destination[x] = source->blocks[ChunkDims::Index(sourceX + x, y, sourceZ + z)];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // States are only unpacked when some chunk in the neighbourhood has any
+    snapshot.hasStates = false;
+    for (int dz = -1; dz <= 1; dz++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            const Chunk* source = (dx == 0 && dz == 0) ? &chunk : chunk.GetNeighbor(dx, dz);
+            snapshot.hasStates |= source && source->HasStates();
+        }
+    }
+    if (!snapshot.hasStates) return;
+
+    std::fill(snapshot.states.begin(), snapshot.states.end(), (unsigned char)0);
+    for (int dz = -1; dz <= 1; dz++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            const Chunk* source = (dx == 0 && dz == 0) ? &chunk : chunk.GetNeighbor(dx, dz);
+            if (!source || !source->HasStates()) continue;
+
+            const int firstX = dx < 0 ? -1 : (dx == 0 ? 0 : CHUNK_SIZE);
+            const int firstZ = dz < 0 ? -1 : (dz == 0 ? 0 : CHUNK_SIZE);
+            const int width = dx == 0 ? CHUNK_SIZE : 1;
+            const int depth = dz == 0 ? CHUNK_SIZE : 1;
+
+            for (int y = 0; y < WORLD_HEIGHT; y++) {
+                for (int z = firstZ; z < firstZ + depth; z++) {
+                    for (int x = firstX; x < firstX + width; x++) {
+                        snapshot.states[ChunkSnapshot::Index(x, y, z)] =
+                            source->GetState(x - dx * CHUNK_SIZE, y, z - dz * CHUNK_SIZE);
+                    }
+                }
+            }
+        }
+    }
+}
+
+unsigned char OptimizedWorld::GetBlockState(BlockPos pos) const {
+    if (pos.y < 0 || pos.y >= WORLD_HEIGHT) return 0;
+
+    const Chunk* chunk = GetChunk(pos.x, pos.z);
+    if (!chunk) return 0;
+
+    auto [localX, localY, localZ] = WorldToLocalPos(pos.x, pos.y, pos.z);
+    return chunk->GetState(localX, localY, localZ);
 }
 
-void OptimizedWorld::SetBlock(Vector3 worldPos, Block block) {
-    int x = (int)floorf(worldPos.x);
-    int y = (int)floorf(worldPos.y);
-    int z = (int)floorf(worldPos.z);
+void OptimizedWorld::SetBlock(BlockPos pos, Block block, unsigned char state) {
+    const int x = pos.x;
+    const int y = pos.y;
+    const int z = pos.z;
 
     if (y < 0 || y >= WORLD_HEIGHT) return;
 
@@ -125,124 +1190,374 @@ void OptimizedWorld::SetBlock(Vector3 worldPos, Block block) {
     if (!chunk) return;
 
     auto [localX, localY, localZ] = WorldToLocalPos(x, y, z);
-    chunk->SetBlock(localX, localY, localZ, block);
-    cacheDirty = true;
+    chunk->SetBlock(localX, localY, localZ, block, state);
+    chunk->modified = true;
+    chunk->unsaved = true;
+    if (chunkIO) {
+        journalBatch.push_back({ chunk->x, chunk->z, (localY * CHUNK_SIZE + localZ) * CHUNK_SIZE + localX,
+            block.type, (unsigned char)(state & BLOCK_STATE_MASK) });
+    }
+
+    // Border edits change the visible faces of the neighbouring chunk too
+    Chunk* border[] = {
+        localX == CHUNK_SIZE - 1 ? chunk->neighbors[0] : nullptr,
+        localX == 0 ? chunk->neighbors[1] : nullptr,
+        localZ == CHUNK_SIZE - 1 ? chunk->neighbors[2] : nullptr,
+        localZ == 0 ? chunk->neighbors[3] : nullptr
+    };
+    for (Chunk* neighbor : border) {
+        if (neighbor) neighbor->dirty = true;
+    }
 }
 
 void OptimizedWorld::PlaceBlock(Vector3 position, int blockType) {
-    Vector3 blockPos = {
-        floorf(position.x),
-        floorf(position.y),
-        floorf(position.z)
-    };
-    SetBlock(blockPos, Block((unsigned char)blockType));
+    SetBlock(BlockPos::FromVector(position), Block((unsigned char)blockType));
+}
+
+void OptimizedWorld::PlaceBlock(Vector3 position, int blockType, Vector3 faceNormal, Vector3 hitPoint) {
+    unsigned char state = 0;
+    if (blockType == BLOCK_WOOD) {
+        state = faceNormal.x != 0.0f ? BLOCK_AXIS_X : (faceNormal.z != 0.0f ? BLOCK_AXIS_Z : BLOCK_AXIS_Y);
+    }
+    else if (blockType == BLOCK_SLAB) {
+        // Under a ceiling or on the upper half of a wall, the slab hangs from the top
+        const bool upper = faceNormal.y < 0.0f || (faceNormal.y == 0.0f && hitPoint.y - floorf(hitPoint.y) > 0.5f);
+        state = upper ? SLAB_TOP : SLAB_BOTTOM;
+    }
+    SetBlock(BlockPos::FromVector(position), Block((unsigned char)blockType), state);
 }
 
 void OptimizedWorld::BreakBlock(Vector3 position) {
-    Vector3 blockPos = {
-        floorf(position.x),
-        floorf(position.y),
-        floorf(position.z)
-    };
-    SetBlock(blockPos, Block(BLOCK_AIR));
+    SetBlock(BlockPos::FromVector(position), Block(BLOCK_AIR));
 }
 
 bool OptimizedWorld::IsBlockAt(Vector3 position) const {
     return GetBlock(position).IsSolid();
 }
 
-void OptimizedWorld::GenerateTerrain() {
-    const int worldSize = GetWorldSize();
+bool OptimizedWorld::GetCollisionBox(int x, int y, int z, BoundingBox& box) const {
+    const Block block = GetBlock(x, y, z);
+    if (!block.IsSolid()) return false;
 
-    for (int x = 0; x < worldSize; x++) {
-        for (int z = 0; z < worldSize; z++) {
-            float noise = GetNoise(x * 0.05f, z * 0.05f);
-            int height = 20 + (int)(noise * 15.0f);
+    const BlockExtent extent = block.IsStateful() ? GetBlockExtent(block.type, GetBlockState({ x, y, z }))
+        : BlockExtent{ 0.0f, 1.0f };
+    box.min = { (float)x, y + extent.bottom, (float)z };
+    box.max = { (float)(x + 1), y + extent.top, (float)(z + 1) };
+    return true;
+}
 
-            for (int y = 0; y < WORLD_HEIGHT; y++) {
-                Vector3 pos = { (float)x, (float)y, (float)z };
+bool OptimizedWorld::Raycast(Vector3 origin, Vector3 direction, float maxDistance, RaycastHit& hit) const {
+    if (Vector3LengthSqr(direction) == 0.0f) return false;
+    Vector3 dir = Vector3Normalize(direction);
 
-                if (y > height) {
-                    SetBlock(pos, Block(BLOCK_AIR));
-                }
-                else if (y == height) {
-                    if (height < 22) {
-                        SetBlock(pos, Block(BLOCK_SAND));
-                    }
-                    else if (height > 30) {
-                        SetBlock(pos, Block(BLOCK_STONE));
-                    }
-                    else {
-                        SetBlock(pos, Block(BLOCK_GRASS));
-                    }
+    const int x = (int)floorf(origin.x);
+    int y = (int)floorf(origin.y);
+    const int z = (int)floorf(origin.z);
+
+    const int stepX = dir.x > 0.0f ? 1 : (dir.x < 0.0f ? -1 : 0);
+    const int stepY = dir.y > 0.0f ? 1 : (dir.y < 0.0f ? -1 : 0);
+    const int stepZ = dir.z > 0.0f ? 1 : (dir.z < 0.0f ? -1 : 0);
+
+    // Ray length needed to cross one cell on each axis
+    const float deltaX = stepX != 0 ? fabsf(1.0f / dir.x) : INFINITY;
+    const float deltaY = stepY != 0 ? fabsf(1.0f / dir.y) : INFINITY;
+    const float deltaZ = stepZ != 0 ? fabsf(1.0f / dir.z) : INFINITY;
+
+    // Ray length to the first cell boundary on each axis
+    float maxX = stepX > 0 ? (x + 1 - origin.x) * deltaX : (stepX < 0 ? (origin.x - x) * deltaX : INFINITY);
+    float maxY = stepY > 0 ? (y + 1 - origin.y) * deltaY : (stepY < 0 ? (origin.y - y) * deltaY : INFINITY);
+    float maxZ = stepZ > 0 ? (z + 1 - origin.z) * deltaZ : (stepZ < 0 ? (origin.z - z) * deltaZ : INFINITY);
+
+    float distance = 0.0f;
+    Vector3 normal = { 0.0f, 0.0f, 0.0f };
+
+    // The cursor keeps the chunk under the ray cached between steps
+    BlockCursor cursor(*this, { x, y, z });
+
+    while (distance <= maxDistance) {
+        // Nothing to hit above or below the world once the ray heads further out
+        y = cursor.GetY();
+        if ((y >= WORLD_HEIGHT && stepY >= 0) || (y < 0 && stepY <= 0)) return false;
+
+        // Leap over the largest empty region around the cell: a missing chunk, an empty
+        // section or an empty brick. Cells inside are crossed without touching any block.
+        if (y >= 0 && y < WORLD_HEIGHT) {
+            const Chunk* chunk = cursor.GetChunk();
+            const int localX = cursor.GetLocalX();
+            const int localZ = cursor.GetLocalZ();
+
+            int regionXZ = 0, regionY = 0;
+            if (!chunk) {
+                regionXZ = CHUNK_SIZE;
+                regionY = WORLD_HEIGHT;
+            }
+            else if (chunk->IsSectionEmpty(y)) {
+                regionXZ = CHUNK_SIZE;
+                regionY = SECTION_HEIGHT;
+            }
+            else if (chunk->IsBrickEmpty(localX, y, localZ)) {
+                regionXZ = BRICK_SIZE;
+                regionY = BRICK_SIZE;
+            }
+            else if (chunk->GetBlock(localX, y, localZ).IsSolid()) {
+                BlockPos cell = cursor.GetPos();
+                hit.blockPos = { (float)cell.x, (float)cell.y, (float)cell.z };
+                hit.normal = normal;
+                hit.point = Vector3Add(origin, Vector3Scale(dir, distance));
+                hit.distance = distance;
+                return true;
+            }
+
+            if (regionXZ > 0) {
+                // Cells left until the region boundary on each axis, and the ray length there
+                int cellsX = stepX > 0 ? regionXZ - localX % regionXZ : localX % regionXZ + 1;
+                int cellsY = stepY > 0 ? regionY - y % regionY : y % regionY + 1;
+                int cellsZ = stepZ > 0 ? regionXZ - localZ % regionXZ : localZ % regionXZ + 1;
+                float exitX = stepX != 0 ? maxX + (cellsX - 1) * deltaX : INFINITY;
+                float exitY = stepY != 0 ? maxY + (cellsY - 1) * deltaY : INFINITY;
+                float exitZ = stepZ != 0 ? maxZ + (cellsZ - 1) * deltaZ : INFINITY;
+
+                // Same tie-breaking as the single step below, so both visit the same cells
+                int exitAxis = (exitX < exitY && exitX < exitZ) ? 0 : (exitY < exitZ ? 1 : 2);
+                float exitDistance = exitAxis == 0 ? exitX : (exitAxis == 1 ? exitY : exitZ);
+
+                // Catch up the other axes on the steps they take inside the region
+                int moveX = 0, moveY = 0, moveZ = 0;
+                while (exitAxis != 0 && maxX < exitDistance) { moveX += stepX; maxX += deltaX; }
+                while (exitAxis != 1 && maxY < exitDistance) { moveY += stepY; maxY += deltaY; }
+                while (exitAxis != 2 && maxZ < exitDistance) { moveZ += stepZ; maxZ += deltaZ; }
+
+                if (exitAxis == 0) {
+                    moveX = stepX * cellsX;
+                    maxX += cellsX * deltaX;
+                    normal = { (float)-stepX, 0.0f, 0.0f };
                 }
-                else if (y > height - 4) {
-                    SetBlock(pos, Block(BLOCK_DIRT));
+                else if (exitAxis == 1) {
+                    moveY = stepY * cellsY;
+                    maxY += cellsY * deltaY;
+                    normal = { 0.0f, (float)-stepY, 0.0f };
                 }
                 else {
-                    SetBlock(pos, Block(BLOCK_STONE));
+                    moveZ = stepZ * cellsZ;
+                    maxZ += cellsZ * deltaZ;
+                    normal = { 0.0f, 0.0f, (float)-stepZ };
                 }
+                cursor.Move(moveX, moveY, moveZ);
+                distance = exitDistance;
+                continue;
             }
+        }
 
-            // Add trees
-            if (height >= 22 && height <= 30) {
-                if ((rand() % 100) < 8) {
-                    AddTree(x, height + 1, z);
-                }
-            }
+        // Step into whichever neighbouring cell the ray reaches first
+        if (maxX < maxY && maxX < maxZ) {
+            cursor.Move(stepX, 0, 0);
+            distance = maxX;
+            maxX += deltaX;
+            normal = { (float)-stepX, 0.0f, 0.0f };
+        }
+        else if (maxY < maxZ) {
+            cursor.Move(0, stepY, 0);
+            distance = maxY;
+            maxY += deltaY;
+            normal = { 0.0f, (float)-stepY, 0.0f };
+        }
+        else {
+            cursor.Move(0, 0, stepZ);
+            distance = maxZ;
+            maxZ += deltaZ;
+            normal = { 0.0f, 0.0f, (float)-stepZ };
+        }
+    }
 
-            // Add water
-            for (int y = 0; y < 16; y++) {
-                Vector3 pos = { (float)x, (float)y, (float)z };
-                if (y < height && GetBlock(pos).type == BLOCK_AIR) {
-                    SetBlock(pos, Block(BLOCK_WATER));
+    return false;
+}
+
+void OptimizedWorld::RaycastBatch(const Vector3* origins, const Vector3* directions, const float* maxDistances,
+    int count, RaycastHit* hits, bool* results) const {
+    // Chunks are only read here and the call blocks until every ray is done,
+    // so the workers need no locking against Update/SetBlock
+    workers.ParallelFor(count, RAYCAST_BATCH_GRAIN, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            results[i] = Raycast(origins[i], directions[i], maxDistances[i], hits[i]);
+        }
+    });
+}
+
+namespace {
+    // world.dat: what a save needs beyond its region files
+    struct WorldHeader {
+        uint32_t magic;
+        uint32_t version;
+        int32_t seed;
+        uint32_t chunkSize;
+        uint32_t worldHeight;
+    };
+
+    const uint32_t WORLD_MAGIC = 0x44574352;  // "RCWD"
+    const uint32_t WORLD_VERSION = 1;
+}
+
+bool OptimizedWorld::Save(const std::string& directory, RegionFormat format) {
+    // The journal already has every edit the region files miss
+    if (chunkIO && chunkIO->GetDirectory() == directory && format == saveFormat) {
+        SubmitJournalBatch();
+        return true;
+    }
+
+    if (!chunkIO || chunkIO->GetDirectory() != directory) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+
+        // Chunks written to the old save may no longer be in memory, so its region files
+        // come along. Its mappings go away with it.
+        if (chunkIO) {
+            FlushIO();
+            for (Chunk* chunk : chunks) {
+                if (chunk) chunk->Unmap();
+            }
+            for (const auto& [key, chunk] : parkedChunks) {
+                chunk->Unmap();
+            }
+            for (const auto& entry : std::filesystem::directory_iterator(chunkIO->GetDirectory(), error)) {
+                if (entry.path().extension() == ".rcr") {
+                    std::filesystem::copy_file(entry.path(), std::filesystem::path(directory) / entry.path().filename(),
+                        std::filesystem::copy_options::overwrite_existing, error);
                 }
             }
         }
+
+        const WorldHeader header = { WORLD_MAGIC, WORLD_VERSION, seed, CHUNK_SIZE, WORLD_HEIGHT };
+        std::ofstream file(std::filesystem::path(directory) / "world.dat", std::ios::binary | std::ios::trunc);
+        file.write((const char*)&header, sizeof(header));
+        if (!file) return false;
+
+        // A journal left behind by another world would be replayed into this one
+        std::filesystem::remove(std::filesystem::path(directory) / "journal.rcj", error);
+        chunkIO = std::make_unique<ChunkIO>(directory, true);
+    }
+
+    saveFormat = format;
+    for (Chunk* chunk : chunks) {
+        if (chunk) QueueChunkWrite(chunk);
     }
+    for (const auto& [key, chunk] : parkedChunks) {
+        QueueChunkWrite(chunk);
+    }
+    CompactJournal();
+    return true;
+}
+
+bool OptimizedWorld::Load(const std::string& directory, bool mapRegions) {
+    WorldHeader header = {};
+    std::ifstream file(std::filesystem::path(directory) / "world.dat", std::ios::binary);
+    if (!file.read((char*)&header, sizeof(header)) || header.magic != WORLD_MAGIC || header.version != WORLD_VERSION
+        || header.chunkSize != CHUNK_SIZE || header.worldHeight != WORLD_HEIGHT) {
+        return false;
+    }
+
+    // Writes of the old world still land before it is dropped
+    if (chunkIO) {
+        CancelReads();
+        FlushIO();
+    }
+    DiscardChunks();
+    seed = header.seed;
+
+    // Edits that never reached the region files, applied as their chunks come in
+    std::vector<JournalEdit> edits;
+    EditJournal::Read((std::filesystem::path(directory) / "journal.rcj").string(), edits);
+    journalReplay.clear();
+    for (const JournalEdit& edit : edits) {
+        journalReplay[((long long)edit.chunkX << 32) | (unsigned int)edit.chunkZ].push_back(edit);
+    }
+    journalEdits = (int)edits.size();
+    chunkIO = std::make_unique<ChunkIO>(directory, mapRegions);
 
-    cacheDirty = true;
+    // The far ring was estimated from the old seed
+    farTerrain.Unload();
+    return true;
 }
 
-void OptimizedWorld::UpdateVisibleBlocks(Vector3 playerPos) {
-    if (!cacheDirty) return;
+void OptimizedWorld::FlushIO() {
+    if (!chunkIO) return;
+    SubmitJournalBatch();
+    SubmitWriteBatch();
+    chunkIO->Flush();
+}
 
-    visibleBlocks.clear();
-    const int worldSize = GetWorldSize();
-    const int renderDistance = 24;
+ChunkIOStats OptimizedWorld::GetIOStats() const {
+    return chunkIO ? chunkIO->GetStats() : ChunkIOStats{};
+}
 
-    // Calculate visible area around player
-    int minX = std::max(0, (int)playerPos.x - renderDistance);
-    int maxX = std::min(worldSize - 1, (int)playerPos.x + renderDistance);
-    int minZ = std::max(0, (int)playerPos.z - renderDistance);
-    int maxZ = std::min(worldSize - 1, (int)playerPos.z + renderDistance);
+void OptimizedWorld::GenerateChunk(Chunk& chunk) {
+    const int baseX = chunk.x * CHUNK_SIZE;
+    const int baseZ = chunk.z * CHUNK_SIZE;
+    std::fill_n(chunk.storage, CHUNK_VOLUME, Block(BLOCK_AIR));
 
-    // Frustum culling (simplified - just distance based)
-    for (int x = minX; x <= maxX; x++) {
-        for (int z = minZ; z <= maxZ; z++) {
-            for (int y = 0; y < WORLD_HEIGHT; y++) {
-                Vector3 pos = { (float)x + 0.5f, (float)y + 0.5f, (float)z + 0.5f };
-                Block block = GetBlock({ (float)x, (float)y, (float)z });
-
-                if (block.type == BLOCK_AIR) continue;
-
-                // Simple visibility check: check if any neighbor is air
-                bool visible =
-                    GetBlock({ (float)x + 1, (float)y, (float)z }).IsTransparent() ||
-                    GetBlock({ (float)x - 1, (float)y, (float)z }).IsTransparent() ||
-                    GetBlock({ (float)x, (float)y + 1, (float)z }).IsTransparent() ||
-                    GetBlock({ (float)x, (float)y - 1, (float)z }).IsTransparent() ||
-                    GetBlock({ (float)x, (float)y, (float)z + 1 }).IsTransparent() ||
-                    GetBlock({ (float)x, (float)y, (float)z - 1 }).IsTransparent();
-
-                if (visible) {
-                    visibleBlocks.push_back({ pos, block.GetColor(), block.type == BLOCK_WATER });
+    for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+        for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+            int height = GetTerrainHeight(baseX + lx, baseZ + lz);
+
+            for (int y = 0; y <= std::min(height, WORLD_HEIGHT - 1); y++) {
+                if (y == height) {
+                    chunk.SetBlock(lx, y, lz, GetSurfaceBlock(height));
+                }
+                else if (y > height - 4) {
+                    chunk.SetBlock(lx, y, lz, Block(BLOCK_DIRT));
+                }
+                else {
+                    chunk.SetBlock(lx, y, lz, Block(BLOCK_STONE));
+                }
+            }
+
+            // Add water
+            for (int y = 0; y < 16; y++) {
+                if (y < height && chunk.GetBlock(lx, y, lz).type == BLOCK_AIR) {
+                    chunk.SetBlock(lx, y, lz, Block(BLOCK_WATER));
                 }
             }
         }
     }
 
-    cacheDirty = false;
+    // Trees from this chunk and from columns close enough for their leaves to reach in.
+    // Visiting them in world order keeps overlapping trees identical across chunk borders.
+    const int treeReach = 3;
+    for (int wx = baseX - treeReach; wx < baseX + CHUNK_SIZE + treeReach; wx++) {
+        for (int wz = baseZ - treeReach; wz < baseZ + CHUNK_SIZE + treeReach; wz++) {
+            int height = GetTerrainHeight(wx, wz);
+            if (height < 22 || height > 30) continue;
+
+            unsigned int hash = GetColumnHash(wx, wz);
+            if ((hash % 100) < 8) {
+                AddTree(chunk, wx, height + 1, wz, hash);
+            }
+        }
+    }
+
+    chunk.dirty = true;
+    chunk.modified = false;
+    farTerrain.RefineTile(chunk);
+}
+
+int OptimizedWorld::GetTerrainHeight(int worldX, int worldZ) const {
+    float noise = GetNoise(worldX * 0.05f, worldZ * 0.05f);
+    return 20 + (int)(noise * 15.0f);
+}
+
+Block OptimizedWorld::GetSurfaceBlock(int height) const {
+    if (height < 22) return Block(BLOCK_SAND);
+    if (height > 30) return Block(BLOCK_STONE);
+    return Block(BLOCK_GRASS);
+}
+
+unsigned int OptimizedWorld::GetColumnHash(int worldX, int worldZ) const {
+    // Stateless per-column hash so any chunk can be generated in any order
+    unsigned int h = (unsigned int)seed;
+    h ^= (unsigned int)worldX * 0x27d4eb2du;
+    h = (h ^ (h >> 15)) * 0x85ebca6bu;
+    h ^= (unsigned int)worldZ * 0x165667b1u;
+    h = (h ^ (h >> 13)) * 0xc2b2ae35u;
+    return h ^ (h >> 16);
 }
 
 float OptimizedWorld::GetNoise(float x, float z) const {
@@ -254,12 +1569,14 @@ float OptimizedWorld::GetNoise(float x, float z) const {
     return (noise + 1.0f) * 0.5f;
 }
 
-void OptimizedWorld::AddTree(int worldX, int worldY, int worldZ) {
-    int trunkHeight = 3 + (rand() % 3);
+void OptimizedWorld::AddTree(Chunk& chunk, int worldX, int worldY, int worldZ, unsigned int hash) {
+    const int baseX = chunk.x * CHUNK_SIZE;
+    const int baseZ = chunk.z * CHUNK_SIZE;
+    int trunkHeight = 3 + ((hash >> 8) % 3);
 
     // Trunk
     for (int i = 0; i < trunkHeight; i++) {
-        SetBlock({ (float)worldX, (float)(worldY + i), (float)worldZ }, Block(BLOCK_WOOD));
+        chunk.SetBlock(worldX - baseX, worldY + i, worldZ - baseZ, Block(BLOCK_WOOD));
     }
 
     // Leaves
@@ -268,15 +1585,14 @@ void OptimizedWorld::AddTree(int worldX, int worldY, int worldZ) {
         int radius = (dy == 0) ? 2 : (dy == 1) ? 3 : 2;
         for (int dx = -radius; dx <= radius; dx++) {
             for (int dz = -radius; dz <= radius; dz++) {
-                // Fixed: Explicit cast to float
                 float fdx = static_cast<float>(dx);
                 float fdy = static_cast<float>(dy);
                 float fdz = static_cast<float>(dz);
                 float distance = sqrtf(fdx * fdx + fdz * fdz + fdy * fdy);
 
+                // Chunk::SetBlock ignores the parts of the tree outside this chunk
                 if (distance <= static_cast<float>(radius)) {
-                    SetBlock({ (float)(worldX + dx), (float)(leavesStart + dy), (float)(worldZ + dz) },
-                        Block(BLOCK_LEAVES));
+                    chunk.SetBlock(worldX + dx - baseX, leavesStart + dy, worldZ + dz - baseZ, Block(BLOCK_LEAVES));
                 }
             }
         }
@@ -285,23 +1601,36 @@ void OptimizedWorld::AddTree(int worldX, int worldY, int worldZ) {
 
 Chunk* OptimizedWorld::GetChunk(int worldX, int worldZ) const {
     auto [chunkX, chunkZ] = WorldToChunkPos(worldX, worldZ);
-    if (chunkX < 0 || chunkX >= CHUNK_COUNT_X || chunkZ < 0 || chunkZ >= CHUNK_COUNT_Z) {
+    return GetChunkAt(chunkX, chunkZ);
+}
+
+Chunk* OptimizedWorld::GetChunkAt(int chunkX, int chunkZ) const {
+    if constexpr (FIXED_WORLD_CHUNKS > 0) {
+        return IsInFixedWorld(chunkX, chunkZ) ? chunks[GetWindowSlot(chunkX, chunkZ)] : nullptr;
+    }
+
+    Chunk* chunk = chunks[GetWindowSlot(chunkX, chunkZ)];
+    if (!chunk || chunk->x != chunkX || chunk->z != chunkZ) {
         return nullptr;
     }
-    return chunks[chunkX][chunkZ];
+    return chunk;
+}
+
+int OptimizedWorld::GetWindowSlot(int chunkX, int chunkZ) const {
+    if constexpr (FIXED_WORLD_CHUNKS > 0) {
+        return (chunkZ - FIXED_WORLD_MIN_CHUNK) * FIXED_WORLD_CHUNKS + (chunkX - FIXED_WORLD_MIN_CHUNK);
+    }
+
+    int slotX = ((chunkX % WINDOW_SIZE) + WINDOW_SIZE) % WINDOW_SIZE;
+    int slotZ = ((chunkZ % WINDOW_SIZE) + WINDOW_SIZE) % WINDOW_SIZE;
+    return slotZ * WINDOW_SIZE + slotX;
 }
 
 std::pair<int, int> OptimizedWorld::WorldToChunkPos(int worldX, int worldZ) const {
-    return {
-        worldX / CHUNK_SIZE,
-        worldZ / CHUNK_SIZE
-    };
+    // Floor division so negative coordinates map to the right chunk
+    return { ChunkDims::ToChunk(worldX), ChunkDims::ToChunk(worldZ) };
 }
 
 std::tuple<int, int, int> OptimizedWorld::WorldToLocalPos(int worldX, int worldY, int worldZ) const {
-    return {
-        worldX % CHUNK_SIZE,
-        worldY,
-        worldZ % CHUNK_SIZE
-    };
+    return { ChunkDims::ToLocal(worldX), worldY, ChunkDims::ToLocal(worldZ) };
 }
\ No newline at end of file
@@ -3,113 +3,571 @@
 
 #include "raylib.h"
 #include "raymath.h"
+#include "FarTerrain.hpp"
+#include "ThreadPool.hpp"
+#include "ChunkPool.hpp"
+#include "BlockTypes.hpp"
+#include "ChunkIO.hpp"
 #include <vector>
 #include <unordered_map>
 #include <array>
+#include <cstdint>
+#include <algorithm>
+#include <bit>
+#include <memory>
+#include <string>
 
-// World constants
-const int WORLD_HEIGHT = 64;
-const int CHUNK_SIZE = 16;
-
-// Optimized block types with integer IDs
-enum BlockType : unsigned char {
-    BLOCK_AIR = 0,
-    BLOCK_GRASS,
-    BLOCK_DIRT,
-    BLOCK_STONE,
-    BLOCK_WOOD,
-    BLOCK_LEAVES,
-    BLOCK_WATER,
-    BLOCK_SAND,
-    BLOCK_COUNT
+// Chunk geometry as compile-time constants. Both sizes are powers of two, so block
+// indices and world-to-chunk conversions reduce to shifts and masks. Blocks are stored
+// in y-z-x rows, or with BrickLayout in 4x4x4 bricks of 64 contiguous blocks so that
+// vertical and depth neighbours usually share a cache line.
+template <int SizeXZ, int Height, bool BrickLayout = false>
+struct ChunkDimensions {
+    static_assert(SizeXZ >= 4 && (SizeXZ & (SizeXZ - 1)) == 0, "Chunk width must be a power of two");
+    static_assert(Height >= 16 && (Height & (Height - 1)) == 0, "World height must be a power of two");
+
+    static constexpr int SIZE = SizeXZ;
+    static constexpr int HEIGHT = Height;
+    static constexpr int VOLUME = SIZE * HEIGHT * SIZE;
+    static constexpr int SHIFT = std::countr_zero((unsigned int)SizeXZ);
+    static constexpr int MASK = SIZE - 1;
+
+    // Whether a run of x at fixed y and z is contiguous in memory
+    static constexpr bool ROWS_CONTIGUOUS = !BrickLayout;
+
+    static constexpr int Index(int x, int y, int z) {
+        if constexpr (BrickLayout) {
+            // Bricks in y-z-x order, then y-z-x inside the brick
+            const int brick = ((((y >> 2) << (SHIFT - 2)) | (z >> 2)) << (SHIFT - 2)) | (x >> 2);
+            return (brick << 6) | ((y & 3) << 4) | ((z & 3) << 2) | (x & 3);
+        }
+        else {
+            return (((y << SHIFT) | z) << SHIFT) | x;
+        }
+    }
+
+    // Arithmetic shift floors negative coordinates as well
+    static constexpr int ToChunk(int world) { return world >> SHIFT; }
+    static constexpr int ToLocal(int world) { return world & MASK; }
 };
 
-// Optimized block data - just a byte
-struct Block {
-    unsigned char type;
+// Build-time chunk geometry, 16x64x16 unless overridden
+#ifndef RAYCRAFT_CHUNK_SIZE
+#define RAYCRAFT_CHUNK_SIZE 16
+#endif
+#ifndef RAYCRAFT_WORLD_HEIGHT
+#define RAYCRAFT_WORLD_HEIGHT 64
+#endif
+#ifndef RAYCRAFT_BRICK_LAYOUT
+#define RAYCRAFT_BRICK_LAYOUT 0
+#endif
+using ChunkDims = ChunkDimensions<RAYCRAFT_CHUNK_SIZE, RAYCRAFT_WORLD_HEIGHT, RAYCRAFT_BRICK_LAYOUT != 0>;
+
+// World constants
+const int WORLD_HEIGHT = ChunkDims::HEIGHT;
+const int CHUNK_SIZE = ChunkDims::SIZE;
+const int CHUNK_VOLUME = ChunkDims::VOLUME;
+
+// Fixed-size world mode: building with RAYCRAFT_FIXED_WORLD_CHUNKS=N generates a bounded
+// N x N chunk world centred on the origin up front, stored in one contiguous allocation,
+// instead of streaming an unbounded world around the player
+#ifndef RAYCRAFT_FIXED_WORLD_CHUNKS
+#define RAYCRAFT_FIXED_WORLD_CHUNKS 0
+#endif
+const int FIXED_WORLD_CHUNKS = RAYCRAFT_FIXED_WORLD_CHUNKS;
+const int FIXED_WORLD_MIN_CHUNK = -FIXED_WORLD_CHUNKS / 2;
 
-    Block(unsigned char t = BLOCK_AIR) : type(t) {}
-
-    Color GetColor() const {
-        static const std::array<Color, BLOCK_COUNT> colors = { {
-            BLANK,                     // AIR
-            GREEN,                     // GRASS
-            BROWN,                     // DIRT
-            GRAY,                      // STONE
-            Color{139, 69, 19, 255},   // WOOD
-            Color{34, 139, 34, 200},   // LEAVES
-            Color{0, 105, 148, 150},   // WATER
-            Color{194, 178, 128, 255}  // SAND
-        } };
-        return colors[type];
+// Occupancy hierarchy used to skip empty space: sections of 4x4x4 bricks, as tall as
+// lets each section's bricks fit one 64-bit mask (16 blocks for 16-wide chunks)
+const int BRICK_SIZE = 4;
+const int BRICK_COLUMNS = (CHUNK_SIZE / BRICK_SIZE) * (CHUNK_SIZE / BRICK_SIZE);
+static_assert(BRICK_COLUMNS <= 64, "Chunks wider than 32 blocks do not fit a 64-bit brick mask");
+const int SECTION_HEIGHT = std::min(WORLD_HEIGHT, BRICK_SIZE * (64 / BRICK_COLUMNS));
+const int SECTION_COUNT = WORLD_HEIGHT / SECTION_HEIGHT;
+const int SECTION_VOLUME = SECTION_HEIGHT * CHUNK_SIZE * CHUNK_SIZE;
+
+// Visits the chunks at Chebyshev distance `distance` from the centre chunk
+template <typename Fn>
+void ForEachInRing(int centerX, int centerZ, int distance, Fn fn) {
+    if (distance == 0) {
+        fn(centerX, centerZ);
+        return;
+    }
+    for (int dx = -distance; dx <= distance; dx++) {
+        fn(centerX + dx, centerZ - distance);
+        fn(centerX + dx, centerZ + distance);
+    }
+    for (int dz = -distance + 1; dz <= distance - 1; dz++) {
+        fn(centerX - distance, centerZ + dz);
+        fn(centerX + distance, centerZ + dz);
     }
+}
 
-    bool IsTransparent() const {
-        return type == BLOCK_AIR || type == BLOCK_LEAVES || type == BLOCK_WATER;
+// Integer block coordinates in world space
+struct BlockPos {
+    int x, y, z;
+
+    // Face order matches the mesher: +X, -X, +Y, -Y, +Z, -Z
+    static constexpr int FACE_COUNT = 6;
+    static constexpr int FACE_OFFSETS[FACE_COUNT][3] = {
+        { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+    };
+
+    BlockPos Offset(int dx, int dy, int dz) const { return { x + dx, y + dy, z + dz }; }
+    BlockPos Neighbor(int face) const {
+        return Offset(FACE_OFFSETS[face][0], FACE_OFFSETS[face][1], FACE_OFFSETS[face][2]);
     }
 
-    bool IsSolid() const {
-        return type != BLOCK_AIR && type != BLOCK_WATER;
+    // Cell containing a world-space point
+    static BlockPos FromVector(Vector3 position) {
+        return { (int)floorf(position.x), (int)floorf(position.y), (int)floorf(position.z) };
     }
 };
 
+// Optimized block data - just a byte. Properties come from the BlockTypes tables.
+struct Block {
+    unsigned char type;
+
+    constexpr Block(unsigned char t = BLOCK_AIR) : type(t) {}
+
+    Color GetColor() const { return BlockTables::COLORS[type]; }
+    unsigned char GetFlags() const { return BlockTables::FLAGS[type]; }
+    bool HasFlags(unsigned char flags) const { return (GetFlags() & flags) != 0; }
+    const BlockDefinition& GetDefinition() const { return BlockTables::DEFINITIONS[type]; }
+
+    // Lets light and neighbouring faces through
+    bool IsTransparent() const { return !HasFlags(BLOCK_FLAG_OPAQUE); }
+
+    bool IsSolid() const { return HasFlags(BLOCK_FLAG_SOLID); }
+
+    // Blended blocks that go into the translucent render pass
+    bool IsTranslucent() const { return HasFlags(BLOCK_FLAG_TRANSLUCENT); }
+
+    // Has faces to mesh at all
+    bool IsVisible() const { return HasFlags(BLOCK_FLAG_VISIBLE); }
+
+    // Shape or shading depends on the per-block state nibble
+    bool IsStateful() const { return HasFlags(BLOCK_FLAG_STATEFUL); }
+
+    unsigned char GetLightEmission() const { return GetDefinition().lightEmission; }
+    float GetHardness() const { return GetDefinition().hardness; }
+};
+
+// Chunk storage, snapshots and the fixed world all rely on one byte per block
+static_assert(sizeof(Block) == 1, "Block must stay a single byte");
+
+class OptimizedWorld;
+
+// Copy of a chunk with a one-block halo from its eight neighbours, so meshing can index
+// every neighbour with a constant stride and never touches the world (or other threads)
+struct ChunkSnapshot {
+    static const int SIZE_X = CHUNK_SIZE + 2;
+    static const int SIZE_Y = WORLD_HEIGHT + 2;
+    static const int SIZE_Z = CHUNK_SIZE + 2;
+    static const int STRIDE_Z = SIZE_X;
+    static const int STRIDE_Y = SIZE_X * SIZE_Z;
+
+    int chunkX, chunkZ;
+    uint64_t version;  // Chunk version the copy was taken at
+    std::array<Block, SIZE_X * SIZE_Y * SIZE_Z> blocks;
+
+    // Unpacked block states, only filled when the chunk or a neighbour stores any
+    bool hasStates;
+    std::array<unsigned char, SIZE_X * SIZE_Y * SIZE_Z> states;
+
+    // Chunk-local coordinates, -1 and CHUNK_SIZE / WORLD_HEIGHT address the halo
+    static int Index(int x, int y, int z) { return (y + 1) * STRIDE_Y + (z + 1) * STRIDE_Z + (x + 1); }
+    Block Get(int x, int y, int z) const { return blocks[Index(x, y, z)]; }
+    unsigned char GetState(int index) const { return hasStates ? states[index] : 0; }
+};
+
+// Translucent face kept on the CPU so a chunk can re-sort it back-to-front
+struct TranslucentFace {
+    Vector3 center;
+    int firstVertex;
+};
+
 // Chunk-based system for optimization
 struct Chunk {
+    // Horizontal neighbour directions, +X, -X, +Z, -Z; the opposite of d is d ^ 1
+    static const int NEIGHBOR_COUNT = 4;
+    static constexpr int NEIGHBOR_OFFSETS[NEIGHBOR_COUNT][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
     int x, z;
-    std::vector<Block> blocks;
-    bool dirty;
-    Mesh mesh;
-    Model model;
-    bool initialized;
+    const Block* blocks;  // CHUNK_VOLUME blocks, the pool buffer or a read-only region file mapping
+    Block* storage;       // Pool-owned buffer, the only one ever written
+    bool dirty;     // Mesh must be rebuilt even if the version has not moved (neighbour edits, unloaded meshes)
+    bool modified;  // Edited by the player since generation
+    bool unsaved;   // Edited since it was last queued for writing
+    int meshLod;    // Level of detail the current meshes were built at
+
+    // Bumped by every block change; derived data records the version it was built from
+    uint64_t version;
+    uint64_t meshVersion;
+
+    // Loaded horizontal neighbours, linked and unlinked by the world on load/unload
+    Chunk* neighbors[NEIGHBOR_COUNT];
 
-    Chunk(int chunkX, int chunkZ);
+    // Opaque and translucent geometry are kept in separate meshes
+    Mesh opaqueMesh;
+    Mesh translucentMesh;
+    bool hasOpaqueMesh;
+    bool hasTranslucentMesh;
+
+    // Unsorted translucent vertex data, re-sorted when the camera moves far enough
+    std::vector<float> translucentVertices;
+    std::vector<unsigned char> translucentColors;
+    std::vector<TranslucentFace> translucentFaces;
+    Vector3 lastSortPosition;
+
+    // One bit per brick holding at least one solid block, one mask per section
+    std::array<uint64_t, SECTION_COUNT> brickOccupancy;
+
+    // Two 4-bit block states per byte in block index order. Allocated on the first
+    // non-zero state, so generated chunks never carry one.
+    static const int STATE_BYTES = CHUNK_VOLUME / 2;
+    std::unique_ptr<unsigned char[]> states;
+
+    // Copy-on-write snapshot link, see SnapshotFrom. Sections are contiguous in either
+    // block layout since y is the outermost coordinate.
+    Chunk* snapshotSource;    // On a snapshot: the chunk it still shares sections with
+    Chunk* snapshotCopy;      // On that chunk: the snapshot to hand sections to
+    uint32_t sharedSections;  // On a snapshot: sections not yet taken, guarded by a lock
+    static_assert(SECTION_COUNT <= 32, "Shared sections must fit a 32-bit mask");
+
+    explicit Chunk(Block* storage);
     ~Chunk();
 
+    Chunk(const Chunk&) = delete;
+    Chunk& operator=(const Chunk&) = delete;
+
+    // Puts a recycled chunk back into its just-constructed state. Block contents are left
+    // for the generator or loader to overwrite, so mapped chunks never touch their buffer.
+    void Reset(int chunkX, int chunkZ);
+
+    // Reads blocks straight from memory owned elsewhere until the first edit copies them
+    void MapBlocks(const Block* mapped) { blocks = mapped; }
+    bool IsMapped() const { return blocks != storage; }
+    void Unmap();
+
+    // Takes the blocks, states and occupancy of another chunk
+    void CopyBlocksFrom(const Chunk& source);
+
+    // Makes this chunk a snapshot of source for the I/O thread without copying its blocks.
+    // The sections stay shared until ResolveSnapshot takes them, and source hands over a
+    // section before its first write to it, so only sections edited in between are copied
+    // on the calling thread. A mapped source has nothing to share and is copied at once.
+    void SnapshotFrom(Chunk& source);
+    // Takes every section still shared; safe on any thread while the source lives
+    void ResolveSnapshot();
+
+    // Rebuilds the brick occupancy after blocks were written without SetBlock
+    void RecomputeOccupancy();
+
     Block GetBlock(int x, int y, int z) const;
-    void SetBlock(int x, int y, int z, Block block);
+    void SetBlock(int x, int y, int z, Block block, unsigned char state = 0);
+    unsigned char GetState(int x, int y, int z) const;
+    bool HasStates() const { return states != nullptr; }
+
+    // Side or diagonal neighbour, dx and dz in -1..1 and not both zero
+    Chunk* GetNeighbor(int dx, int dz) const;
+    bool NeedsMesh(int lod) const { return dirty || meshVersion != version || meshLod != lod; }
 
-    void GenerateMesh();
-    void Draw();
+    bool IsSectionEmpty(int y) const { return brickOccupancy[y / SECTION_HEIGHT] == 0; }
+    bool IsBrickEmpty(int x, int y, int z) const {
+        return (brickOccupancy[y / SECTION_HEIGHT] & GetBrickBit(x, y, z)) == 0;
+    }
+
+    // Full-detail meshes built from a snapshot of this chunk; lod 1 and 2 are 2x and 4x
+    // downsampled opaque-only meshes built from the chunk alone
+    void GenerateMesh(const ChunkSnapshot& snapshot);
+    void GenerateLodMesh(int lod);
+    void SortTranslucentFaces(Vector3 cameraPos);
+    void UnloadMeshes();
+
+    void DrawOpaque(const Material& material) const;
+    void DrawTranslucent(const Material& material) const;
+
+private:
+    bool ScanBrick(int x, int y, int z) const;
+    void WriteState(int index, unsigned char state);
+    void HandOverSections(uint32_t sections);
+    void DetachSnapshot();
+
+    static uint64_t GetBrickBit(int x, int y, int z) {
+        int brick = ((((y % SECTION_HEIGHT) / BRICK_SIZE) * (CHUNK_SIZE / BRICK_SIZE) + z / BRICK_SIZE)
+            * (CHUNK_SIZE / BRICK_SIZE)) + x / BRICK_SIZE;
+        return 1ull << brick;
+    }
+};
+
+// Result of a voxel raycast
+struct RaycastHit {
+    Vector3 blockPos;  // Integer coordinates of the solid block that was hit
+    Vector3 normal;    // Face the ray entered through, zero if it started inside the block
+    Vector3 point;     // Entry point on that face
+    float distance;    // Distance from the origin to the entry point
+};
+
+// Per-frame render counters shown in the debug overlay
+struct RenderStats {
+    int chunksDrawn;
+    int opaqueFaces;
+    int translucentFaces;
+    int lodTriangles[3];  // Triangles drawn at full, 2x and 4x detail
 };
 
 // Optimized World
 class OptimizedWorld {
+public:
+    // Render distance limits in chunks
+    static constexpr int MIN_RENDER_DISTANCE = 2;
+    static constexpr int MAX_RENDER_DISTANCE = 12;
+
 private:
-    static const int CHUNK_COUNT_X = 4;  // 4x4 chunks = 64x64 world
-    static const int CHUNK_COUNT_Z = 4;
+    // Chunks are streamed in a square window centred on the player, with one extra
+    // loaded ring beyond the render distance so rendered chunks always have neighbours
+    static const int WINDOW_SIZE = 2 * (MAX_RENDER_DISTANCE + 1) + 1;
+    static const int MESH_BUILDS_PER_FRAME = 8;
+
+    // Chunk rings from which the 2x and 4x downsampled meshes are used
+    static const int LOD_2X_DISTANCE = 5;
+    static const int LOD_4X_DISTANCE = 9;
 
-    std::vector<std::vector<Chunk*>> chunks;
+    // Edits logged since the last compaction before the edited chunks are written to their
+    // region files and the journal is emptied
+    static const int JOURNAL_COMPACT_EDITS = 4096;
+
+    // Rays handed to a worker at a time by RaycastBatch
+    static const int RAYCAST_BATCH_GRAIN = 256;
+
+    // Streaming: ring buffer of loaded chunks, slot = (z mod WINDOW_SIZE, x mod WINDOW_SIZE).
+    // Fixed world: every chunk, slot = (z - min) * FIXED_WORLD_CHUNKS + (x - min).
+    static const int GRID_SIZE = FIXED_WORLD_CHUNKS > 0 ? FIXED_WORLD_CHUNKS : WINDOW_SIZE;
+    std::vector<Chunk*> chunks;
+
+    // Fixed world: blocks of the chunk in slot i start at fixedBlocks + i * CHUNK_VOLUME
+    const Block* fixedBlocks;
+    int centerX, centerZ;
+    int renderDistance;
+    int loadDistance;
+    bool windowLoaded;
     int seed;
 
-    // Visible block cache for faster drawing
-    std::vector<std::tuple<Vector3, Color, bool>> visibleBlocks;
-    bool cacheDirty;
+    // Storage for every chunk, loaded or parked
+    ChunkPool chunkPool;
+
+    // Player-edited chunks that slid out of the window, kept so edits survive
+    std::unordered_map<long long, Chunk*> parkedChunks;
+
+    // Heightmap impostor drawn beyond the voxel render distance
+    FarTerrain farTerrain;
+
+    // Saved world chunks are read from before falling back to generation. All region file
+    // access runs on its thread; chunks being read join the window once the read is done.
+    std::unique_ptr<ChunkIO> chunkIO;
+    std::unordered_map<long long, Chunk*> pendingReads;
+
+    // Copy-on-write snapshots of chunks collected during a frame and queued together at its
+    // end, and how many queued writes each chunk is in. A parked chunk is released once it is
+    // on disk.
+    std::vector<Chunk*> writeBatch;
+    std::unordered_map<long long, int> writesInFlight;
+    RegionFormat saveFormat;
+
+    // Edits of the frame, logged together at its end, and how many were logged since the
+    // last compaction or load. Replayed edits wait here until their chunk is read.
+    std::vector<JournalEdit> journalBatch;
+    int journalEdits;
+    std::unordered_map<long long, std::vector<JournalEdit>> journalReplay;
+
+    // Shared material for all chunk meshes
+    Material material;
+    bool materialLoaded;
+
+    // Workers for batched queries; mutable so const queries can be spread across them
+    mutable ThreadPool workers;
+
+    // Reused for every full-detail mesh build
+    ChunkSnapshot meshSnapshot;
+
+    // Chunk draw order, reused between frames to avoid allocations
+    std::vector<std::pair<float, Chunk*>> drawOrder;
+    RenderStats renderStats;
 
 public:
     OptimizedWorld(int worldSeed = 1337);
     ~OptimizedWorld();
 
     void Update(Vector3 playerPos);
-    void Draw();
+    void Draw(const Camera3D& camera);
+    void SetRenderDistance(int distance);
+    int GetRenderDistance() const { return renderDistance; }
+    void UnloadRenderData();
+
+    Block GetBlock(int x, int y, int z) const;
+    Block GetBlock(BlockPos pos) const { return GetBlock(pos.x, pos.y, pos.z); }
+    Block GetBlock(Vector3 worldPos) const { return GetBlock(BlockPos::FromVector(worldPos)); }
+    Block GetNeighbor(BlockPos pos, int face) const { return GetBlock(pos.Neighbor(face)); }
+    bool IsSolidAt(int x, int y, int z) const { return GetBlock(x, y, z).IsSolid(); }
+
+    unsigned char GetBlockState(BlockPos pos) const;
 
-    Block GetBlock(Vector3 worldPos) const;
-    void SetBlock(Vector3 worldPos, Block block);
+    void SetBlock(BlockPos pos, Block block, unsigned char state = 0);
+    void SetBlock(Vector3 worldPos, Block block) { SetBlock(BlockPos::FromVector(worldPos), block); }
     void PlaceBlock(Vector3 position, int blockType);
+    // Places against the face hit at hitPoint; logs follow the face normal and slabs
+    // take the half of the cell that was aimed at
+    void PlaceBlock(Vector3 position, int blockType, Vector3 faceNormal, Vector3 hitPoint);
     void BreakBlock(Vector3 position);
 
     bool IsBlockAt(Vector3 position) const;
-    int GetWorldSize() const { return CHUNK_COUNT_X * CHUNK_SIZE; }
+
+    // World-space box of the solid part of a cell, false if nothing there blocks movement
+    bool GetCollisionBox(int x, int y, int z, BoundingBox& box) const;
+
+    // Copies a loaded chunk and its halo; unloaded neighbours read as air
+    void SnapshotChunk(const Chunk& chunk, ChunkSnapshot& snapshot) const;
+
+    // Grid traversal (Amanatides & Woo) returning the first solid block within maxDistance
+    bool Raycast(Vector3 origin, Vector3 direction, float maxDistance, RaycastHit& hit) const;
+
+    // Casts count rays across the worker threads; results[i] tells whether hits[i] was written
+    void RaycastBatch(const Vector3* origins, const Vector3* directions, const float* maxDistances,
+        int count, RaycastHit* hits, bool* results) const;
+    const RenderStats& GetRenderStats() const { return renderStats; }
+    const FarTerrain& GetFarTerrain() const { return farTerrain; }
+    const ChunkPool& GetChunkPool() const { return chunkPool; }
+    ChunkIOStats GetIOStats() const;
+
+    // Logs the edits made since the last save to the journal of directory and returns
+    // without waiting. Edited chunks are written to the region files when they leave the
+    // window and every JOURNAL_COMPACT_EDITS edits. Saving to a new directory or in another
+    // format writes a snapshot of every loaded and parked chunk instead, which costs a few
+    // pointers per chunk here and a section copy per section edited before it is written.
+    // A new directory first waits for the old save and copies its region files, then
+    // writes the world seed.
+    bool Save(const std::string& directory, RegionFormat format = REGION_COMPRESSED);
+    // Switches to a saved world: its seed is restored, every chunk is dropped and chunks
+    // found in its region files are read instead of generated from then on, with the edits
+    // of its journal replayed on top. Mappable records are referenced in place unless
+    // mapRegions is false.
+    bool Load(const std::string& directory, bool mapRegions = true);
+    // Waits until every queued read and write is done; for shutdown
+    void FlushIO();
+
+    // True while the chunk under a position is still being read from disk
+    bool IsWaitingForChunk(Vector3 worldPos) const;
+
+    // Generator surface, available for any column without generating voxels
+    int GetTerrainHeight(int worldX, int worldZ) const;
+    Block GetSurfaceBlock(int height) const;
 
 private:
-    void GenerateTerrain();
-    void UpdateVisibleBlocks(Vector3 playerPos);
-    void AddTree(int worldX, int worldY, int worldZ);
+    friend class BlockCursor;
+
+    void SlideWindow(int newCenterX, int newCenterZ);
+    void LoadFixedWorld();
+    int GetLodForRing(int ring) const;
+    void LoadChunk(int chunkX, int chunkZ);
+    // Reads an acquired chunk from disk, or generates it without a save, into its slot
+    void FillChunk(Chunk* chunk);
+    void UnloadChunk(int chunkX, int chunkZ);
+    void ReleaseChunk(Chunk* chunk);
+    void DiscardChunks();
+
+    void OnChunkRead(Chunk* chunk, bool found);
+    void CancelReads();
+    bool IsWaitingForNeighbors(const Chunk& chunk) const;
+    void QueueChunkWrite(Chunk* chunk);
+    void SubmitWriteBatch();
+    void OnChunksWritten(const std::vector<Chunk*>& copies, bool success);
+    void SubmitJournalBatch();
+    void CompactJournal();
+    void ReplayEdits(Chunk& chunk);
+
+    void GenerateChunk(Chunk& chunk);
+    void AddTree(Chunk& chunk, int worldX, int worldY, int worldZ, unsigned int hash);
+    unsigned int GetColumnHash(int worldX, int worldZ) const;
     float GetNoise(float x, float z) const;
 
     // Helper to get chunk from world position
     Chunk* GetChunk(int worldX, int worldZ) const;
+    Chunk* GetChunkAt(int chunkX, int chunkZ) const;
+    int GetWindowSlot(int chunkX, int chunkZ) const;
+    bool IsInFixedWorld(int chunkX, int chunkZ) const {
+        // One unsigned compare per axis covers both ends of the range
+        return (unsigned int)(chunkX - FIXED_WORLD_MIN_CHUNK) < (unsigned int)FIXED_WORLD_CHUNKS
+            && (unsigned int)(chunkZ - FIXED_WORLD_MIN_CHUNK) < (unsigned int)FIXED_WORLD_CHUNKS;
+    }
+    void LinkNeighbors(Chunk* chunk);
+    void UnlinkNeighbors(Chunk* chunk);
     std::pair<int, int> WorldToChunkPos(int worldX, int worldZ) const;
     std::tuple<int, int, int> WorldToLocalPos(int worldX, int worldY, int worldZ) const;
 };
 
+// Walks the world block by block with the chunk under it cached, so moves only
+// look a chunk up again when they cross a chunk border
+class BlockCursor {
+private:
+    const OptimizedWorld* world;
+    const Chunk* chunk;
+    int chunkX, chunkZ;
+    int localX, y, localZ;
+
+public:
+    BlockCursor(const OptimizedWorld& owner, BlockPos pos) : world(&owner) { MoveTo(pos); }
+
+    void MoveTo(BlockPos pos) {
+        auto [cx, cz] = world->WorldToChunkPos(pos.x, pos.z);
+        chunkX = cx;
+        chunkZ = cz;
+        localX = ChunkDims::ToLocal(pos.x);
+        localZ = ChunkDims::ToLocal(pos.z);
+        y = pos.y;
+        chunk = world->GetChunkAt(chunkX, chunkZ);
+    }
+
+    void Move(int dx, int dy, int dz) {
+        localX += dx;
+        localZ += dz;
+        y += dy;
+        if (localX < 0 || localX >= CHUNK_SIZE || localZ < 0 || localZ >= CHUNK_SIZE) {
+            // Single steps into a linked neighbour skip the window lookup
+            const int shiftX = localX < 0 ? -1 : (localX >= CHUNK_SIZE ? 1 : 0);
+            const int shiftZ = localZ < 0 ? -1 : (localZ >= CHUNK_SIZE ? 1 : 0);
+            Chunk* next = chunk && localX >= -CHUNK_SIZE && localX < 2 * CHUNK_SIZE
+                && localZ >= -CHUNK_SIZE && localZ < 2 * CHUNK_SIZE ? chunk->GetNeighbor(shiftX, shiftZ) : nullptr;
+            if (!next) {
+                MoveTo(GetPos());
+                return;
+            }
+            chunk = next;
+            chunkX += shiftX;
+            chunkZ += shiftZ;
+            localX -= shiftX * CHUNK_SIZE;
+            localZ -= shiftZ * CHUNK_SIZE;
+        }
+    }
+
+    BlockPos GetPos() const { return { chunkX * CHUNK_SIZE + localX, y, chunkZ * CHUNK_SIZE + localZ }; }
+    const Chunk* GetChunk() const { return chunk; }
+    int GetY() const { return y; }
+    int GetLocalX() const { return localX; }
+    int GetLocalZ() const { return localZ; }
+
+    // Air above and below the world and in chunks that are not loaded
+    Block GetBlock() const { return chunk ? chunk->GetBlock(localX, y, localZ) : Block(BLOCK_AIR); }
+
+    Block GetNeighbor(int face) const {
+        const int nx = localX + BlockPos::FACE_OFFSETS[face][0];
+        const int nz = localZ + BlockPos::FACE_OFFSETS[face][2];
+        const int ny = y + BlockPos::FACE_OFFSETS[face][1];
+        if (nx >= 0 && nx < CHUNK_SIZE && nz >= 0 && nz < CHUNK_SIZE) {
+            return chunk ? chunk->GetBlock(nx, ny, nz) : Block(BLOCK_AIR);
+        }
+        return world->GetBlock(GetPos().Neighbor(face));
+    }
+};
+
 #endif
\ No newline at end of file